@@ -0,0 +1,523 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#include "RamaSaveSystemPrivatePCH.h"
+#include "RamaSaveArchive.h"
+
+#include "RamaSaveClassPlan.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// String Table
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+uint32 FRamaSaveStringTable::Add(const FString& Value)
+{
+	if(const uint32* Found = StringIndices.Find(Value))
+	{
+		return *Found;
+	}
+	
+	const uint32 Index = Strings.Add(Value);
+	StringIndices.Add(Value, Index);
+	return Index;
+}
+
+uint32 FRamaSaveStringTable::Add(FName Value)
+{
+	if(const uint32* Found = NameIndices.Find(Value))
+	{
+		return *Found;
+	}
+	const uint32 Index = Add(Value.ToString());
+	NameIndices.Add(Value, Index);
+	return Index;
+}
+
+uint32 FRamaSaveStringTable::Add(UObject* Object)
+{
+	if(ObjectPaths)
+	{
+		const FString* Path = Object ? ObjectPaths->Find(Object) : nullptr;
+		if(Object && !Path)
+		{
+			MissingObjectPaths++;
+		}
+		return Add(Path ? *Path : FString());
+	}
+	
+	const FObjectKey Key(Object);
+	if(const uint32* Found = ObjectIndices.Find(Key))
+	{
+		return *Found;
+	}
+	const uint32 Index = Add(Object ? Object->GetPathName() : FString());
+	ObjectIndices.Add(Key, Index);
+	return Index;
+}
+
+UObject* FRamaSaveStringTable::FindObject(uint32 Index, bool bLoadIfFindFails)
+{
+	//Paths that were not found stay null, no second lookup
+	if(const TWeakObjectPtr<UObject>* Found = Objects.Find(Index))
+	{
+		if(!Found->IsStale())
+		{
+			return Found->Get();
+		}
+	}
+	
+	//Same as FObjectAndNameAsStringProxyArchive
+	const FString& Path = Strings[Index];
+	UObject* Object = nullptr;
+	if(!Path.IsEmpty())
+	{
+		Object = ::FindObject<UObject>(nullptr, *Path, false);
+		if(!Object && bLoadIfFindFails)
+		{
+			Object = LoadObject<UObject>(nullptr, *Path);
+		}
+	}
+	
+	Objects.Add(Index, Object);
+	return Object;
+}
+
+void FRamaSaveStringTable::Reset()
+{
+	Strings.Reset();
+	Names.Reset();
+	StringIndices.Reset();
+	NameIndices.Reset();
+	ObjectIndices.Reset();
+	Objects.Reset();
+}
+
+FArchive& operator<<(FArchive& Ar, FRamaSaveStringTable& Table)
+{
+	Ar << Table.Strings;
+	
+	if(Ar.IsLoading())
+	{
+		Table.Names.Reset(Table.Strings.Num());
+		for(const FString& Each : Table.Strings)
+		{
+			Table.Names.Add(FName(*Each));
+		}
+	}
+	return Ar;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Actor Directory
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void FRamaSaveActorDirectory::Add(FRamaSaveStringTable& Strings, int64 RecordBegin, const FString& ActorClass, const FString& LevelPackageName, const FGuid& PersistentActorUniqueID, const TArray<FString>& SaveTags, const TArray<uint32>& ObjectIndices)
+{
+	FRamaSaveDirectoryEntry& Entry = Entries[Entries.AddDefaulted()];
+	Entry.RecordBegin = RecordBegin;
+	Entry.ClassIndex = Strings.Add(ActorClass);
+	Entry.LevelIndex = Strings.Add(LevelPackageName);
+	Entry.PersistentActorUniqueID = PersistentActorUniqueID;
+	Entry.ObjectIndices = ObjectIndices;
+	
+	for(const FString& EachTag : SaveTags)
+	{
+		const uint32 TagIndex = Strings.Add(EachTag);
+		
+		int32* Bit = TagBits.Find(TagIndex);
+		if(!Bit && TagIndices.Num() < MaxTagBits)
+		{
+			Bit = &TagBits.Add(TagIndex, TagIndices.Add(TagIndex));
+		}
+		
+		Entry.TagMask |= Bit ? (1ull << *Bit) : TagOverflow;
+	}
+}
+
+void FRamaSaveActorDirectory::Reset()
+{
+	TagIndices.Reset();
+	Entries.Reset();
+	TagBits.Reset();
+}
+
+void FRamaSaveActorDirectory::FindCandidates(const FRamaSaveStringTable& Strings, const TArray<FString>& LoadActorsWithSaveTags, const FString& LoadOnlyStreamingLevel, TArray<int32>& OutEntries) const
+{
+	//Level filter, resolved to string table indices once
+	const bool bFilterLevel = LoadOnlyStreamingLevel != "" && LoadOnlyStreamingLevel != "Old File Version, Re-save this file to get level streaming info! <3 Rama";
+	TBitArray<> LevelMatches(false, Strings.Strings.Num());
+	if(bFilterLevel)
+	{
+		for(int32 v = 0; v < Strings.Strings.Num(); v++)
+		{
+			LevelMatches[v] = Strings.Strings[v] == LoadOnlyStreamingLevel;
+		}
+	}
+	
+	//Tag filter, resolved to a mask once
+	const bool bFilterTags = LoadActorsWithSaveTags.Num() > 0;
+	uint64 WantedTags = TagOverflow;
+	for(int32 Bit = 0; Bit < TagIndices.Num(); Bit++)
+	{
+		const uint32 TagIndex = TagIndices[Bit];
+		if(Strings.Strings.IsValidIndex(TagIndex) && LoadActorsWithSaveTags.Contains(Strings.Strings[TagIndex]))
+		{
+			WantedTags |= 1ull << Bit;
+		}
+	}
+	
+	OutEntries.Reset(Entries.Num());
+	for(int32 v = 0; v < Entries.Num(); v++)
+	{
+		const FRamaSaveDirectoryEntry& Entry = Entries[v];
+		
+		if(bFilterLevel && !(LevelMatches.IsValidIndex(Entry.LevelIndex) && LevelMatches[Entry.LevelIndex]))
+		{
+			continue;
+		}
+		if(bFilterTags && !(Entry.TagMask & WantedTags))
+		{
+			continue;
+		}
+		OutEntries.Add(v);
+	}
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Property Layouts
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+FString FRamaSaveLayoutTable::GetTypeName(UProperty* Property)
+{
+	//"TArray" + "<int32>", struct and object types by name
+	FString ExtendedType;
+	FString Type = Property->GetCPPType(&ExtendedType);
+	return Type + ExtendedType;
+}
+
+uint32 FRamaSaveLayoutTable::HashEntry(const FString& Name, const FString& Type, uint32 Hash)
+{
+	Hash = FCrc::StrCrc32(*Name, Hash);
+	return FCrc::StrCrc32(*Type, Hash);
+}
+
+uint32 FRamaSaveLayoutTable::Add(FRamaSaveStringTable& Strings, TArrayView<UProperty* const> Properties)
+{
+	uint32 PropertiesHash = 0;
+	for(UProperty* Property : Properties)
+	{
+		PropertiesHash = HashCombine(PropertiesHash, PointerHash(Property));
+	}
+	
+	TArray<uint32, TInlineAllocator<4>> Candidates;
+	LayoutsByProperties.MultiFind(PropertiesHash, Candidates);
+	for(uint32 Index : Candidates)
+	{
+		const TArray<UProperty*>& Each = LayoutProperties[Index];
+		if(Each.Num() == Properties.Num() && FMemory::Memcmp(Each.GetData(), Properties.GetData(), Each.Num() * sizeof(UProperty*)) == 0)
+		{
+			return Index;
+		}
+	}
+	
+	//First block with these properties, the only time names and types are looked at
+	const uint32 Index = Layouts.Num();
+	FRamaSaveLayout& Layout = Layouts[Layouts.AddDefaulted()];
+	for(UProperty* Property : Properties)
+	{
+		const FString Type = GetTypeName(Property);
+		Layout.NameIndices.Add(Strings.Add(Property->GetFName()));
+		Layout.TypeIndices.Add(Strings.Add(Type));
+		Layout.Hash = HashEntry(Property->GetName(), Type, Layout.Hash);
+	}
+	
+	LayoutProperties.Emplace(Properties.GetData(), Properties.Num());
+	LayoutsByProperties.Add(PropertiesHash, Index);
+	return Index;
+}
+
+const FRamaSaveLayout* FRamaSaveLayoutTable::Load(FArchive& Ar) const
+{
+	uint32 Index = 0;
+	Ar.SerializeIntPacked(Index);
+	if(!Layouts.IsValidIndex(Index))
+	{
+		Ar.ArIsError = true;
+		return nullptr;
+	}
+	return &Layouts[Index];
+}
+
+const TArray<UProperty*>& FRamaSaveLayoutTable::Resolve(const FRamaSaveStringTable& Strings, const FRamaSaveLayout& Layout, UClass* Class, bool& bMatches)
+{
+	const TPair<TWeakObjectPtr<UClass>, const FRamaSaveLayout*> Key(Class, &Layout);
+	if(const TUniquePtr<FResolved>* Found = Resolved.Find(Key))
+	{
+		bMatches = (*Found)->bMatches;
+		return (*Found)->Properties;
+	}
+	
+	FResolved& Entry = *Resolved.Add(Key, MakeUnique<FResolved>());
+	
+	//By name, then one hash of what the class has now for those names
+	const FRamaSaveClassPlan& Plan = FRamaSaveClassPlan::Get(Class);
+	TArray<FString, TInlineAllocator<16>> Types;
+	bool bAllFound = true;
+	uint32 Hash = 0;
+	for(int32 v = 0; v < Layout.NameIndices.Num(); v++)
+	{
+		const FName& Name = Strings.Names[Layout.NameIndices[v]];
+		UProperty* Property = Plan.FindProperty(Name);
+		Entry.Properties.Add(Property);
+		Types.Add(Property ? GetTypeName(Property) : FString());
+		
+		bAllFound &= Property != nullptr;
+		Hash = HashEntry(Strings.Strings[Layout.NameIndices[v]], Types[v], Hash);
+	}
+	Entry.bMatches = bAllFound && Hash == Layout.Hash;
+	
+	if(!Entry.bMatches)
+	{
+		//Class changed since the file was written, drop properties whose type changed
+		for(int32 v = 0; v < Entry.Properties.Num(); v++)
+		{
+			if(Entry.Properties[v] && Types[v] != Strings.Strings[Layout.TypeIndices[v]])
+			{
+				UE_LOG(RamaSave, Warning, TEXT("Property type changed since the file was saved, not loaded %s %s"), *Class->GetName(), *Entry.Properties[v]->GetName());
+				Entry.Properties[v] = nullptr;
+			}
+		}
+	}
+	
+	bMatches = Entry.bMatches;
+	return Entry.Properties;
+}
+
+bool FRamaSaveLayoutTable::IsValid(const FRamaSaveStringTable& Strings) const
+{
+	for(const FRamaSaveLayout& Layout : Layouts)
+	{
+		if(Layout.NameIndices.Num() != Layout.TypeIndices.Num())
+		{
+			return false;
+		}
+		for(int32 v = 0; v < Layout.NameIndices.Num(); v++)
+		{
+			if(!Strings.Strings.IsValidIndex(Layout.NameIndices[v]) || !Strings.Strings.IsValidIndex(Layout.TypeIndices[v]))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void FRamaSaveLayoutTable::Reset()
+{
+	Layouts.Reset();
+	LayoutsByProperties.Reset();
+	LayoutProperties.Reset();
+	Resolved.Reset();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Archive
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void FRamaSaveArchive::SerializeString(FString& Value)
+{
+	if(!Strings)
+	{
+		*this << Value;
+		return;
+	}
+	
+	uint32 Index = 0;
+	if(IsSaving())
+	{
+		Index = Strings->Add(Value);
+		SaveStringIndex(Index);
+	}
+	else
+	{
+		SerializeIntPacked(Index);
+	}
+	
+	if(IsLoading())
+	{
+		if(!Strings->Strings.IsValidIndex(Index))
+		{
+			ArIsError = true;
+			Value.Empty();
+			return;
+		}
+		Value = Strings->Strings[Index];
+	}
+}
+
+void FRamaSaveArchive::SerializeName(FName& Value)
+{
+	if(!Strings)
+	{
+		FString NameString = IsSaving() ? Value.ToString() : FString();
+		*this << NameString;
+		if(IsLoading())
+		{
+			Value = FName(*NameString);
+		}
+		return;
+	}
+	
+	uint32 Index = 0;
+	if(IsSaving())
+	{
+		Index = Strings->Add(Value);
+		SaveStringIndex(Index);
+	}
+	else
+	{
+		SerializeIntPacked(Index);
+	}
+	
+	if(IsLoading())
+	{
+		if(!Strings->Names.IsValidIndex(Index))
+		{
+			ArIsError = true;
+			Value = NAME_None;
+			return;
+		}
+		Value = Strings->Names[Index];
+	}
+}
+
+FArchive& FRamaSaveArchive::operator<<(FName& Value)
+{
+	if(!Strings || !bReferenceTable)
+	{
+		return FObjectAndNameAsStringProxyArchive::operator<<(Value);
+	}
+	
+	SerializeName(Value);
+	return *this;
+}
+
+FArchive& FRamaSaveArchive::operator<<(UObject*& Value)
+{
+	if(!Strings || !bReferenceTable)
+	{
+		return FObjectAndNameAsStringProxyArchive::operator<<(Value);
+	}
+	
+	uint32 Index = 0;
+	if(IsSaving())
+	{
+		Index = Strings->Add(Value);
+		SaveStringIndex(Index);
+	}
+	else
+	{
+		SerializeIntPacked(Index);
+	}
+	
+	if(ObjectReferences && Value)
+	{
+		ObjectReferences->AddUnique(Index);
+	}
+	
+	if(IsLoading())
+	{
+		if(!Strings->Strings.IsValidIndex(Index))
+		{
+			ArIsError = true;
+			Value = nullptr;
+			return *this;
+		}
+		Value = Strings->FindObject(Index, bLoadIfFindFails);
+	}
+	return *this;
+}
+
+void FRamaSaveArchive::SaveStringIndex(uint32 Index)
+{
+	if(!StringFixups)
+	{
+		SerializeIntPacked(Index);
+		return;
+	}
+	
+	//Same bytes SerializeIntPacked reads, 7 bits each with the low bit set on all but the last
+	checkf(Index < (1u << (7 * FixedIndexBytes)), TEXT("Rama Save System ~ Too many strings for one save"));
+	StringFixups->Add(Tell());
+	
+	uint8 Bytes[FixedIndexBytes];
+	for(int32 v = 0; v < FixedIndexBytes; v++)
+	{
+		Bytes[v] = (((Index >> (7 * v)) & 0x7f) << 1) | (v < FixedIndexBytes - 1 ? 1 : 0);
+	}
+	Serialize(Bytes, FixedIndexBytes);
+}
+
+void FRamaSaveArchive::RemapStringIndex(uint8* Index, const TArray<uint32>& Remap)
+{
+	uint32 Value = 0;
+	for(int32 v = 0; v < FixedIndexBytes; v++)
+	{
+		Value |= uint32(Index[v] >> 1) << (7 * v);
+	}
+	
+	Value = Remap[Value];
+	for(int32 v = 0; v < FixedIndexBytes; v++)
+	{
+		Index[v] = (((Value >> (7 * v)) & 0x7f) << 1) | (v < FixedIndexBytes - 1 ? 1 : 0);
+	}
+}
+
+int64 FRamaSaveArchive::LoadSizedEnd()
+{
+	uint32 Size = 0;
+	SerializeIntPacked(Size);
+	return Tell() + Size;
+}
+
+FRamaSaveArchive& FRamaSaveArchive::BeginSized()
+{
+	check(IsSaving() && !bInSized);
+	bInSized = true;
+	
+	if(!ScratchArchive.IsValid())
+	{
+		ScratchWriter.Reset(new FMemoryWriter(Scratch, IsPersistent()));
+		ScratchWriter->SetUE4Ver(UE4Ver());
+		ScratchWriter->SetEngineVer(EngineVer());
+		
+		ScratchArchive.Reset(new FRamaSaveArchive(*ScratchWriter, false, Strings));
+	}
+	ScratchArchive->Layouts = Layouts;
+	ScratchArchive->ObjectReferences = ObjectReferences;
+	ScratchArchive->StringFixups = StringFixups ? &ScratchFixups : nullptr;
+	
+	Scratch.Reset();
+	ScratchFixups.Reset();
+	ScratchWriter->Seek(0);
+	return *ScratchArchive;
+}
+
+void FRamaSaveArchive::EndSized()
+{
+	check(bInSized);
+	bInSized = false;
+	
+	if(ScratchArchive->IsError())
+	{
+		ArIsError = true;
+	}
+	
+	uint32 Size = Scratch.Num();
+	SerializeIntPacked(Size);
+	
+	//Offsets in the blob to offsets in this archive
+	const int64 BlobBegin = Tell();
+	if(StringFixups)
+	{
+		for(int64 Each : ScratchFixups)
+		{
+			StringFixups->Add(BlobBegin + Each);
+		}
+	}
+	Serialize(Scratch.GetData(), Size);
+}
\ No newline at end of file
@@ -0,0 +1,604 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#include "RamaSaveSystemPrivatePCH.h"
+#include "RamaSaveBlockArchive.h"
+#include "RamaSaveSystemSettings.h"
+#include "ParallelFor.h"
+#include "MappedFileHandle.h"
+
+#include "zlib.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Blocks
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+namespace RamaSaveBlockFile
+{
+	//All compressing codecs write zlib streams, so any of them decodes with COMPRESS_ZLIB
+	int32 GetZlibLevel(ERamaSaveCodec Codec)
+	{
+		switch(Codec)
+		{
+			case ERamaSaveCodec::Fast: 		return Z_BEST_SPEED;
+			case ERamaSaveCodec::HighRatio: return Z_BEST_COMPRESSION;
+			default: 						return Z_DEFAULT_COMPRESSION;
+		}
+	}
+
+	bool CompressBlock(ERamaSaveCodec Codec, const uint8* Raw, int32 RawSize, TArray<uint8>& Block)
+	{
+		if(Codec == ERamaSaveCodec::None) return false;
+
+		uLongf CompressedSize = compressBound(RawSize);
+		Block.SetNumUninitialized(CompressedSize);
+
+		if(compress2(Block.GetData(), &CompressedSize, Raw, RawSize, GetZlibLevel(Codec)) != Z_OK)
+		{
+			return false;
+		}
+
+		//Incompressible, not worth decompressing on load
+		if(CompressedSize >= (uLongf)RawSize)
+		{
+			return false;
+		}
+
+		Block.SetNum(CompressedSize, false);
+		return true;
+	}
+
+	bool DecompressBlock(bool bStoredRaw, uint8* Raw, int32 RawSize, const uint8* Stored, int32 StoredSize)
+	{
+		if(bStoredRaw)
+		{
+			FMemory::Memcpy(Raw, Stored, RawSize);
+			return true;
+		}
+		return FCompression::UncompressMemory(ECompressionFlags::COMPRESS_ZLIB, Raw, RawSize, Stored, StoredSize);
+	}
+
+	int32 GetWindowBlocks()
+	{
+		const int64 WindowBytes = (int64)URamaSaveSystemSettings::Get()->StreamingWindowSizeMB * 1024 * 1024;
+		return (int32)FMath::Clamp<int64>(WindowBytes / BlockSize, 1, 1024);
+	}
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Header
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool FRamaSaveBlockHeader::Read(FArchive& Ar)
+{
+	uint32 Magic = 0;
+	uint8 CodecByte = (uint8)ERamaSaveCodec::Zlib;
+	int64 BlockTableOffset = 0;
+
+	Ar << Magic;
+	Ar << Version;
+	if(Version >= RamaSaveBlockFile::Version_Codec)
+	{
+		Ar << CodecByte;
+	}
+	Ar << BlockSize;
+	Ar << UncompressedSize;
+	Ar << NumBlocks;
+	if(Version >= RamaSaveBlockFile::Version_TableAtEnd)
+	{
+		Ar << BlockTableOffset;
+	}
+
+	if(Ar.IsError() || Magic != RamaSaveBlockFile::Magic || Version > RamaSaveBlockFile::Version || CodecByte > (uint8)ERamaSaveCodec::HighRatio)
+	{
+		UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ Block file header is not valid or from a newer version!"));
+		return false;
+	}
+	if(BlockSize <= 0 || UncompressedSize < 0 || NumBlocks != (int32)((UncompressedSize + BlockSize - 1) / BlockSize) || (int64)NumBlocks * sizeof(int32) > Ar.TotalSize())
+	{
+		UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ Block file sizes are corrupt!"));
+		return false;
+	}
+	Codec = (ERamaSaveCodec)CodecByte;
+
+	//~~~ Block Table ~~~
+	int64 BlocksBegin = Ar.Tell();
+	if(Version >= RamaSaveBlockFile::Version_TableAtEnd)
+	{
+		if(BlockTableOffset < BlocksBegin || BlockTableOffset > Ar.TotalSize())
+		{
+			UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ Block file is truncated!"));
+			return false;
+		}
+		Ar.Seek(BlockTableOffset);
+	}
+
+	StoredSizes.SetNum(NumBlocks);
+	for(int32 BlockIndex = 0; BlockIndex < NumBlocks; BlockIndex++)
+	{
+		Ar << StoredSizes[BlockIndex];
+	}
+
+	if(Version < RamaSaveBlockFile::Version_TableAtEnd)
+	{
+		BlocksBegin = Ar.Tell();
+	}
+
+	//~~~ Turned into file offsets ~~~
+	FileOffsets.SetNum(NumBlocks);
+
+	int64 Offset = BlocksBegin;
+	for(int32 BlockIndex = 0; BlockIndex < NumBlocks; BlockIndex++)
+	{
+		if(StoredSizes[BlockIndex] <= 0) return false;
+
+		FileOffsets[BlockIndex] = Offset;
+		Offset += StoredSizes[BlockIndex];
+	}
+	if(Ar.IsError() || Offset > Ar.TotalSize())
+	{
+		UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ Block file is truncated!"));
+		return false;
+	}
+
+	return true;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Writer
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+FRamaSaveBlockWriter::FRamaSaveBlockWriter(FArchive* InInner, bool bInOwnsInner, ERamaSaveCodec InCodec)
+	: Inner(InInner)
+	, bOwnsInner(bInOwnsInner)
+	, Codec(InCodec)
+{
+	ArIsSaving = true;
+	ArIsPersistent = true;
+
+	WindowBlocks = RamaSaveBlockFile::GetWindowBlocks();
+	Pending.Reserve(WindowBlocks * RamaSaveBlockFile::BlockSize);
+	Window.SetNum(WindowBlocks);
+
+	//~~~ Header ~~~
+	BlobBegin = Inner->Tell();
+	
+	uint32 Magic = RamaSaveBlockFile::Magic;
+	uint32 Version = RamaSaveBlockFile::Version;
+	uint8 CodecByte = (uint8)Codec;
+	int32 BlockSize = RamaSaveBlockFile::BlockSize;
+	*Inner << Magic;
+	*Inner << Version;
+	*Inner << CodecByte;
+	*Inner << BlockSize;
+
+	//Sizes and table offset are filled in by Close()
+	HeaderSizesPos = Inner->Tell();
+	int64 SizePlaceholder = 0;
+	int32 NumBlocksPlaceholder = 0;
+	int64 TablePlaceholder = 0;
+	*Inner << SizePlaceholder;
+	*Inner << NumBlocksPlaceholder;
+	*Inner << TablePlaceholder;
+}
+
+FRamaSaveBlockWriter::~FRamaSaveBlockWriter()
+{
+	Close();
+}
+
+FRamaSaveBlockWriter* FRamaSaveBlockWriter::CreateFile(const FString& FullFilePath, ERamaSaveCodec InCodec)
+{
+	FArchive* FileWriter = IFileManager::Get().CreateFileWriter(*FullFilePath);
+	if(!FileWriter)
+	{
+		return nullptr;
+	}
+	return new FRamaSaveBlockWriter(FileWriter, true, InCodec);
+}
+
+void FRamaSaveBlockWriter::Serialize(void* Data, int64 Num)
+{
+	if(bClosed)
+	{
+		ArIsError = true;
+		return;
+	}
+
+	const int64 WindowBytes = (int64)WindowBlocks * RamaSaveBlockFile::BlockSize;
+
+	const uint8* Src = (const uint8*)Data;
+	while(Num > 0)
+	{
+		const int64 Count = FMath::Min<int64>(Num, WindowBytes - Pending.Num());
+		Pending.Append(Src, (int32)Count);
+
+		Src += Count;
+		Num -= Count;
+		UncompressedSize += Count;
+
+		if(Pending.Num() >= WindowBytes)
+		{
+			WritePendingBlocks();
+		}
+	}
+}
+
+void FRamaSaveBlockWriter::WritePendingBlocks()
+{
+	const int32 BlockSize = RamaSaveBlockFile::BlockSize;
+	const int32 PendingBlocks = (Pending.Num() + BlockSize - 1) / BlockSize;
+
+	//~~~ Compress the window on the task graph ~~~
+	ParallelFor(PendingBlocks, [&](int32 WindowIndex)
+	{
+		const int32 Offset = WindowIndex * BlockSize;
+		const int32 RawSize = FMath::Min(BlockSize, Pending.Num() - Offset);
+
+		TArray<uint8>& Block = Window[WindowIndex];
+		if(!RamaSaveBlockFile::CompressBlock(Codec, Pending.GetData() + Offset, RawSize, Block))
+		{
+			//Stored raw, Reset keeps the allocation for the next window
+			Block.Reset();
+		}
+	});
+
+	//~~~ Write out in order ~~~
+	for(int32 WindowIndex = 0; WindowIndex < PendingBlocks; WindowIndex++)
+	{
+		const int32 Offset = WindowIndex * BlockSize;
+		const int32 RawSize = FMath::Min(BlockSize, Pending.Num() - Offset);
+
+		TArray<uint8>& Block = Window[WindowIndex];
+		if(Block.Num())
+		{
+			StoredSizes.Add(Block.Num());
+			Inner->Serialize(Block.GetData(), Block.Num());
+		}
+		else
+		{
+			StoredSizes.Add(RawSize);
+			Inner->Serialize(Pending.GetData() + Offset, RawSize);
+		}
+	}
+
+	Pending.Reset();
+
+	if(Inner->IsError())
+	{
+		ArIsError = true;
+	}
+}
+
+bool FRamaSaveBlockWriter::Close()
+{
+	if(bClosed)
+	{
+		return !ArIsError;
+	}
+	bClosed = true;
+
+	WritePendingBlocks();
+
+	//~~~ Block Table ~~~
+	int64 BlockTableOffset = Inner->Tell() - BlobBegin;
+	for(int32& EachSize : StoredSizes)
+	{
+		*Inner << EachSize;
+	}
+	const int64 EndPos = Inner->Tell();
+
+	//~~~ Patch Header ~~~
+	int32 NumBlocks = StoredSizes.Num();
+	Inner->Seek(HeaderSizesPos);
+	*Inner << UncompressedSize;
+	*Inner << NumBlocks;
+	*Inner << BlockTableOffset;
+	Inner->Seek(EndPos);
+
+	if(Inner->IsError())
+	{
+		ArIsError = true;
+	}
+
+	if(bOwnsInner)
+	{
+		if(!Inner->Close())
+		{
+			ArIsError = true;
+		}
+		delete Inner;
+		Inner = nullptr;
+	}
+
+	//Free the window now
+	Pending.Empty();
+	Window.Empty();
+
+	return !ArIsError;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Reader
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+FRamaSaveBlockReader::FRamaSaveBlockReader(FArchive* InInner, bool bInOwnsInner, int32 InWindowBlocks)
+	: Inner(InInner)
+	, bOwnsInner(bInOwnsInner)
+{
+	ArIsLoading = true;
+	ArIsPersistent = true;
+
+	WindowBlocks = (InWindowBlocks > 0) ? InWindowBlocks : RamaSaveBlockFile::GetWindowBlocks();
+	bValid = Header.Read(*Inner);
+}
+
+FRamaSaveBlockReader::~FRamaSaveBlockReader()
+{
+	Close();
+}
+
+FRamaSaveBlockReader* FRamaSaveBlockReader::OpenFile(const FString& FullFilePath, int32 InWindowBlocks)
+{
+	FArchive* FileReader = IFileManager::Get().CreateFileReader(*FullFilePath);
+	if(!FileReader)
+	{
+		return nullptr;
+	}
+
+	//Old single stream file?
+	uint32 Magic = 0;
+	*FileReader << Magic;
+	FileReader->Seek(0);
+	if(Magic != RamaSaveBlockFile::Magic)
+	{
+		delete FileReader;
+		return nullptr;
+	}
+
+	FRamaSaveBlockReader* Reader = new FRamaSaveBlockReader(FileReader, true, InWindowBlocks);
+	if(!Reader->IsValid())
+	{
+		delete Reader;
+		return nullptr;
+	}
+	return Reader;
+}
+
+void FRamaSaveBlockReader::Serialize(void* Data, int64 Num)
+{
+	uint8* Dest = (uint8*)Data;
+	while(Num > 0)
+	{
+		//Outside the decoded window?
+		if(Pos < WindowBegin || Pos >= WindowEnd)
+		{
+			if(!bValid || Pos < 0 || Pos >= Header.UncompressedSize || !LoadWindow((int32)(Pos / Header.BlockSize)))
+			{
+				ArIsError = true;
+				FMemory::Memzero(Dest, Num);
+				return;
+			}
+		}
+
+		const int64 Count = FMath::Min<int64>(Num, WindowEnd - Pos);
+		FMemory::Memcpy(Dest, Decoded.GetData() + (Pos - WindowBegin), Count);
+
+		Dest += Count;
+		Num -= Count;
+		Pos += Count;
+	}
+}
+
+bool FRamaSaveBlockReader::LoadWindow(int32 FirstBlock)
+{
+	if(!Inner) return false;
+
+	const int32 Count = FMath::Min(WindowBlocks, Header.NumBlocks - FirstBlock);
+	const int32 LastBlock = FirstBlock + Count - 1;
+
+	//~~~ Stored bytes of the window are contiguous in the file ~~~
+	const int64 StoredBegin = Header.FileOffsets[FirstBlock];
+	const int64 StoredEnd = Header.FileOffsets[LastBlock] + Header.StoredSizes[LastBlock];
+
+	Stored.SetNumUninitialized((int32)(StoredEnd - StoredBegin));
+	Inner->Seek(StoredBegin);
+	Inner->Serialize(Stored.GetData(), Stored.Num());
+	if(Inner->IsError())
+	{
+		return false;
+	}
+
+	//~~~ Decompress the window on the task graph ~~~
+	WindowBegin = (int64)FirstBlock * Header.BlockSize;
+	WindowEnd = FMath::Min<int64>(Header.UncompressedSize, (int64)(LastBlock + 1) * Header.BlockSize);
+	Decoded.SetNumUninitialized((int32)(WindowEnd - WindowBegin));
+
+	FThreadSafeBool bFailed = false;
+	ParallelFor(Count, [&](int32 WindowIndex)
+	{
+		const int32 BlockIndex = FirstBlock + WindowIndex;
+
+		if(!RamaSaveBlockFile::DecompressBlock(
+			Header.IsStoredRaw(BlockIndex),
+			Decoded.GetData() + (int64)WindowIndex * Header.BlockSize, Header.GetRawSize(BlockIndex),
+			Stored.GetData() + (Header.FileOffsets[BlockIndex] - StoredBegin), Header.StoredSizes[BlockIndex]
+		))
+		{
+			bFailed = true;
+		}
+	});
+
+	if(bFailed)
+	{
+		WindowBegin = WindowEnd = 0;
+		return false;
+	}
+	return true;
+}
+
+bool FRamaSaveBlockReader::Close()
+{
+	if(bOwnsInner && Inner)
+	{
+		Inner->Close();
+		delete Inner;
+	}
+	Inner = nullptr;
+
+	Decoded.Empty();
+	Stored.Empty();
+
+	return !ArIsError;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Range Reader
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+FRamaSaveRangeReader::FRamaSaveRangeReader(FArchive* InInner, bool bInOwnsInner, int64 InBegin, int64 InSize)
+	: Inner(InInner)
+	, bOwnsInner(bInOwnsInner)
+	, Begin(InBegin)
+	, Size(InSize)
+{
+	ArIsLoading = true;
+	ArIsPersistent = true;
+	
+	Inner->Seek(Begin);
+}
+
+FRamaSaveRangeReader::~FRamaSaveRangeReader()
+{
+	Close();
+}
+
+void FRamaSaveRangeReader::Serialize(void* Data, int64 Num)
+{
+	if(!Inner || Tell() + Num > Size)
+	{
+		ArIsError = true;
+		FMemory::Memzero(Data, Num);
+		return;
+	}
+	Inner->Serialize(Data, Num);
+	
+	if(Inner->IsError())
+	{
+		ArIsError = true;
+	}
+}
+
+void FRamaSaveRangeReader::Seek(int64 InPos)
+{
+	if(!Inner || InPos < 0 || InPos > Size)
+	{
+		ArIsError = true;
+		return;
+	}
+	Inner->Seek(Begin + InPos);
+}
+
+bool FRamaSaveRangeReader::Close()
+{
+	if(bOwnsInner && Inner)
+	{
+		Inner->Close();
+		delete Inner;
+	}
+	Inner = nullptr;
+	
+	return !ArIsError;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Mapped Reader
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+FRamaSaveMappedReader::FRamaSaveMappedReader(IMappedFileHandle* InHandle, IMappedFileRegion* InRegion, int64 PayloadBegin, int64 PayloadSize)
+	: FBufferReader((void*)(InRegion->GetMappedPtr() + PayloadBegin), PayloadSize, false, true)
+	, Handle(InHandle)
+	, Region(InRegion)
+{
+}
+
+FRamaSaveMappedReader::~FRamaSaveMappedReader()
+{
+	//Region before the handle it was mapped from
+	delete Region;
+	delete Handle;
+}
+
+FRamaSaveMappedReader* FRamaSaveMappedReader::OpenFile(const FString& FullFilePath, int64 BlobOffset, int64 BlobSize)
+{
+	//~~~ Header, a few bytes through a regular reader ~~~
+	FRamaSaveBlockHeader Header;
+	{
+		FArchive* FileReader = IFileManager::Get().CreateFileReader(*FullFilePath);
+		if(!FileReader)
+		{
+			return nullptr;
+		}
+		if(BlobSize < 0)
+		{
+			BlobSize = FileReader->TotalSize() - BlobOffset;
+		}
+		
+		FRamaSaveRangeReader BlobReader(FileReader, true, BlobOffset, BlobSize);
+		
+		uint32 Magic = 0;
+		BlobReader << Magic;
+		BlobReader.Seek(0);
+		if(Magic != RamaSaveBlockFile::Magic || !Header.Read(BlobReader))
+		{
+			return nullptr;
+		}
+	}
+	
+	//Raw blocks are back to back, so the uncompressed data is one contiguous range of the file
+	for(int32 BlockIndex = 0; BlockIndex < Header.NumBlocks; BlockIndex++)
+	{
+		if(!Header.IsStoredRaw(BlockIndex))
+		{
+			return nullptr;
+		}
+	}
+	const int64 PayloadBegin = BlobOffset + (Header.NumBlocks ? Header.FileOffsets[0] : 0);
+	
+	//~~~ Map ~~~
+	IMappedFileHandle* Handle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FullFilePath);
+	if(!Handle)
+	{
+		return nullptr;
+	}
+	
+	IMappedFileRegion* Region = Handle->MapRegion(0, Handle->GetFileSize());
+	if(!Region || Region->GetMappedSize() < PayloadBegin + Header.UncompressedSize)
+	{
+		delete Region;
+		delete Handle;
+		return nullptr;
+	}
+	
+	return new FRamaSaveMappedReader(Handle, Region, PayloadBegin, Header.UncompressedSize);
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Offset Writer
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void FRamaSaveOffsetWriter::Serialize(void* Data, int64 Num)
+{
+	if(Num <= 0) return;
+
+	const int64 End = Offset + Num;
+	if(End > Bytes.Num())
+	{
+		Bytes.AddUninitialized((int32)(End - Bytes.Num()));
+	}
+	FMemory::Memcpy(Bytes.GetData() + Offset, Data, Num);
+	Offset = End;
+}
+
+void FRamaSaveOffsetWriter::Seek(int64 InPos)
+{
+	//Can only go back into the scratch bytes, not into what was already handed off
+	if(InPos < BaseOffset || InPos > BaseOffset + Bytes.Num())
+	{
+		UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ Seek outside of the current record! %lld"), InPos);
+		ArIsError = true;
+		return;
+	}
+	Offset = InPos - BaseOffset;
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#include "RamaSaveSystemPrivatePCH.h"
+#include "RamaSaveClassPlan.h"
+
+#include "RamaSaveComponent.h"
+
+//Stale keys (classes unloaded or replaced by hot reload) never match again, they are dropped when a new class is added
+static TMap<TWeakObjectPtr<UClass>, TUniquePtr<FRamaSaveClassPlan>> ClassPlans;
+
+FRamaSaveClassPlan& FRamaSaveClassPlan::Get(UClass* Class)
+{
+	check(IsInGameThread());
+	check(Class);
+	
+	TUniquePtr<FRamaSaveClassPlan>* Found = ClassPlans.Find(Class);
+	if(!Found)
+	{
+		//New class, drop the plans of classes that are gone
+		for(auto It = ClassPlans.CreateIterator(); It; ++It)
+		{
+			if(!It.Key().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+		Found = &ClassPlans.Add(Class);
+	}
+	
+	//Missing, or the blueprint was recompiled since
+	TUniquePtr<FRamaSaveClassPlan>& Plan = *Found;
+	if(!Plan.IsValid() || Plan->BuiltFrom.Get() != Class->PropertyLink)
+	{
+		Plan = MakeUnique<FRamaSaveClassPlan>();
+		Plan->Build(Class);
+	}
+	return *Plan;
+}
+
+void FRamaSaveClassPlan::Build(UClass* Class)
+{
+	BuiltFrom = Class->PropertyLink;
+	
+	for (TFieldIterator<UProperty> It(Class); It; ++It)
+	{
+		UProperty* Property = *It;
+		FieldOrder.Add(Property);
+		
+		if(UObjectProperty* ObjProp = Cast<UObjectProperty>(Property))
+		{
+			ObjectProperties.Add(ObjProp);
+		}
+		
+		//First one found wins, same as FindField
+		if(!PropertiesByName.Contains(Property->GetFName()))
+		{
+			PropertiesByName.Add(Property->GetFName(), Property);
+		}
+	}
+	
+	if(!Class->IsChildOf(URamaSaveComponent::StaticClass()))
+	{
+		return;
+	}
+	
+	//Only properties the user added, not the ones from the base class
+	UClass* SuperClass = UActorComponent::StaticClass();
+	for(UProperty* Property : FieldOrder)
+	{
+		//Dont serialize Delegates! (It breaks them)
+		if(Property->IsA(UMulticastDelegateProperty::StaticClass()))
+		{
+			continue;
+		}
+		
+		//The Uber Graph Frame
+		if(Property->GetName().Contains("UberGraphFrame"))
+		{
+			continue;
+		}
+		
+		if(!FindField<UProperty>(SuperClass, Property->GetFName()))
+		{
+			ComponentProperties.Add(Property);
+		}
+	}
+}
+
+const TArray<UProperty*>& FRamaSaveClassPlan::GetSelection(const TArray<FString>& VarsToSave, bool bSaveGame)
+{
+	return FindOrAddSelection(VarsToSave, bSaveGame).Properties;
+}
+
+const TArray<UObjectProperty*>& FRamaSaveClassPlan::GetObjectSelection(const TArray<FString>& VarsToSave)
+{
+	FSelection& Selection = FindOrAddSelection(VarsToSave, false);
+	if(!Selection.bObjectProperties)
+	{
+		for(UProperty* Property : Selection.Properties)
+		{
+			if(UObjectProperty* ObjProp = Cast<UObjectProperty>(Property))
+			{
+				Selection.ObjectProperties.Add(ObjProp);
+			}
+		}
+		Selection.bObjectProperties = true;
+	}
+	return Selection.ObjectProperties;
+}
+
+FRamaSaveClassPlan::FSelection* FRamaSaveClassPlan::FindSelection(const TArray<FString>& VarsToSave, bool bSaveGame, bool bNamed, uint32& OutHash)
+{
+	//Case insensitive like the TArray<FString> compare
+	OutHash = (bSaveGame ? 1 : 0) | (bNamed ? 2 : 0);
+	for(const FString& Each : VarsToSave)
+	{
+		OutHash = HashCombine(OutHash, GetTypeHash(Each));
+	}
+	
+	TArray<int32, TInlineAllocator<4>> Candidates;
+	SelectionsByHash.MultiFind(OutHash, Candidates);
+	for(int32 Index : Candidates)
+	{
+		FSelection& Each = Selections[Index];
+		if(Each.bNamed == bNamed && Each.bSaveGame == bSaveGame && Each.VarsToSave == VarsToSave)
+		{
+			return &Each;
+		}
+	}
+	return nullptr;
+}
+
+FRamaSaveClassPlan::FSelection& FRamaSaveClassPlan::AddSelection(const TArray<FString>& VarsToSave, bool bSaveGame, bool bNamed, uint32 Hash)
+{
+	SelectionsByHash.Add(Hash, Selections.Num());
+	
+	FSelection& Selection = *new(Selections) FSelection();
+	Selection.VarsToSave = VarsToSave;
+	Selection.bSaveGame = bSaveGame;
+	Selection.bNamed = bNamed;
+	return Selection;
+}
+
+FRamaSaveClassPlan::FSelection& FRamaSaveClassPlan::FindOrAddSelection(const TArray<FString>& VarsToSave, bool bSaveGame)
+{
+	uint32 Hash = 0;
+	if(FSelection* Found = FindSelection(VarsToSave, bSaveGame, false, Hash))
+	{
+		return *Found;
+	}
+	
+	FSelection& Selection = AddSelection(VarsToSave, bSaveGame, false, Hash);
+	
+	//Case insensitive like TArray<FString>::Contains
+	TSet<FString> Names(VarsToSave);
+	for(UProperty* Property : FieldOrder)
+	{
+		if((bSaveGame && Property->HasAnyPropertyFlags(CPF_SaveGame)) || Names.Contains(Property->GetName()))
+		{
+			Selection.Properties.Add(Property);
+		}
+	}
+	return Selection;
+}
+
+const TArray<UProperty*>& FRamaSaveClassPlan::GetNamedProperties(const TArray<FString>& VarsToSave)
+{
+	uint32 Hash = 0;
+	if(FSelection* Found = FindSelection(VarsToSave, false, true, Hash))
+	{
+		return Found->Properties;
+	}
+	
+	FSelection& Selection = AddSelection(VarsToSave, false, true, Hash);
+	
+	for(const FString& Each : VarsToSave)
+	{
+		Selection.Properties.Add(FindProperty(FName(*Each, FNAME_Find)));
+	}
+	return Selection.Properties;
+}
\ No newline at end of file
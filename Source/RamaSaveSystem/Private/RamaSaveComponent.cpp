@@ -8,8 +8,62 @@
 #include "RamaSaveSystemSettings.h"
 
 #include "RamaSaveEngine.h"
+#include "RamaSaveClassPlan.h"
+#include "RamaSaveRegistry.h"
+#include "RamaSaveSnapshot.h"
 #include "StructuredArchiveFromArchive.h"
 
+void URamaSaveComponent::OnRegister()
+{
+	Super::OnRegister();
+	
+	if(IsTemplate()) return;
+	
+	if(FRamaSaveRegistry* Registry = FRamaSaveRegistry::Get(GetWorld()))
+	{
+		Registry->Add(this);
+		RegisteredWorld = GetWorld();
+	}
+}
+
+void URamaSaveComponent::OnUnregister()
+{
+	//The world it was added to, in case it is already being torn down
+	if(FRamaSaveRegistry* Registry = FRamaSaveRegistry::Find(RegisteredWorld.Get()))
+	{
+		Registry->Remove(this);
+	}
+	RegisteredWorld = nullptr;
+	
+	Super::OnUnregister();
+}
+
+void URamaSaveComponent::RamaSave_AddSaveTag(FString SaveTag)
+{
+	RamaSave_SaveTags.AddUnique(SaveTag);
+	RamaSave_SaveTagsChanged();
+}
+
+void URamaSaveComponent::RamaSave_RemoveSaveTag(FString SaveTag)
+{
+	RamaSave_SaveTags.Remove(SaveTag);
+	RamaSave_SaveTagsChanged();
+}
+
+void URamaSaveComponent::RamaSave_SetSaveTags(const TArray<FString>& SaveTags)
+{
+	RamaSave_SaveTags = SaveTags;
+	RamaSave_SaveTagsChanged();
+}
+
+void URamaSaveComponent::RamaSave_SaveTagsChanged()
+{
+	if(FRamaSaveRegistry* Registry = FRamaSaveRegistry::Find(RegisteredWorld.Get()))
+	{
+		Registry->UpdateTags(this);
+	}
+}
+
 bool URamaSaveComponent::GetActorIsInPersistentLevel()
 {
 	AActor* Owner = GetOwner();
@@ -23,6 +77,15 @@ FString URamaSaveComponent::GetActorStreamingLevelPackageName()
 	AActor* Owner = GetOwner();
 	if(!Owner) return "No Owning Actor";
 	
+	//Worked out once per level when the first component of the level registered
+	if(FRamaSaveRegistry* Registry = FRamaSaveRegistry::Find(RegisteredWorld.Get()))
+	{
+		if(const FString* Cached = Registry->FindLevelPackageName(Owner->GetLevel()))
+		{
+			return *Cached;
+		}
+	}
+	
 	//Consistency if it is the persistent level
 	if(Owner->IsInPersistentLevel())
 	{
@@ -39,121 +102,182 @@ FString URamaSaveComponent::GetActorStreamingLevelPackageName()
 }
 
 //This is Static
-bool URamaSaveComponent::RamaSave_LoadFromFile(UWorld* World, int32 RamaSaveSystemVersion, const TArray<FString>& LoadActorsWithSaveTags,  FArchive &Ar, URamaSaveComponent*& LoadedComp, bool DontLoadPlayerPawns, FString LoadOnlyStreamingLevel)
+bool URamaSaveComponent::RamaSave_LoadFromFile(UWorld* World, int32 RamaSaveSystemVersion, const TArray<FString>& LoadActorsWithSaveTags,  FRamaSaveArchive &Ar, URamaSaveComponent*& LoadedComp, bool DontLoadPlayerPawns, FString LoadOnlyStreamingLevel)
 {
-	URamaSaveSystemSettings* Settings = URamaSaveSystemSettings::Get();
-	if(!Settings) 
-	{
-		UE_LOG(RamaSave, Error,TEXT("URamaSaveComponent::RamaSave_LoadFromFile>> Huge big error! Tell Rama!"));
-		return false;
-	}
+	LoadedComp = nullptr;
 	
-	bool GlobalLogging = Settings->Loading_GlobalVerboseLogging;
+	FRamaSaveActorRecord Record;
+	ReadActorRecordHeader(Ar, RamaSaveSystemVersion, Record);
 	
-  
-	LoadedComp = nullptr;
+	if(!ShouldLoadActorRecord(Record, LoadActorsWithSaveTags, LoadOnlyStreamingLevel))
+	{
+		//Skip! Essential to maintain integrity of load process!
+		Ar.Seek(Record.RecordEnd);
+		
+		return true;
+	}
 	
+	return RamaSave_LoadFromRecord(World, Record, Ar, LoadedComp, DontLoadPlayerPawns);
+}
+
+//This is Static, safe to call from a worker thread
+void URamaSaveComponent::ReadActorRecordHeader(FRamaSaveArchive &Ar, int32 RamaSaveSystemVersion, FRamaSaveActorRecord& Record)
+{
 	//! #4 Actor Byte Chunk Skip Position
-	int64 ActorArchiveEndPos = 0; 						
-	Ar << ActorArchiveEndPos;
+	if(Ar.bSizedRecords)
+	{
+		Record.RecordEnd = Ar.LoadSizedEnd();
+	}
+	else
+	{
+		Ar << Record.RecordEnd;
+	}
 	 
 	//! #4 String Actor Class
 	//First Data in file should be the Object Class name
-	FString ActorClassFromFile;
-	Ar << ActorClassFromFile;			
+	Ar.SerializeString(Record.ActorClass);
   
 	//! #4 String Actor Class Path
-	FString ActorClassFullPath;
-	Ar << ActorClassFullPath;	
+	Ar.SerializeString(Record.ActorClassFullPath);
 	  
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	//Ver 3 = FGUID and Actor Tags!
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-
-	FGuid PersistentActorUniqueID;
-	TArray<FString> TempTags;
 	if(RamaSaveSystemVersion > 2)
 	{ 
 		//! #4.5 FGUID !
-		Ar << PersistentActorUniqueID;
+		Ar << Record.PersistentActorUniqueID;
 		
 		//! 4.7333 Actor Tags
-		Ar << TempTags;
+		Ar << Record.SaveTags;
 	}
 	
-	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-	// Streaming Levels Filter <3 Rama
-	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-	 
-	FString LoadedLevelPackageName = "Old File Version, Re-save this file to get level streaming info! <3 Rama";
+	Record.LevelPackageName = "Old File Version, Re-save this file to get level streaming info! <3 Rama";
 	if(RamaSaveSystemVersion > 3)
 	{ 
 		//! 4.9 Level Streaming
-		Ar << LoadedLevelPackageName;
+		Ar.SerializeString(Record.LevelPackageName);
 	}
+	
+	//Properties follow directly
+	Record.PropertiesBegin = Ar.Tell();
+}
+
+//This is Static, safe to call from a worker thread
+bool URamaSaveComponent::ShouldLoadActorRecord(const FRamaSaveActorRecord& Record, const TArray<FString>& LoadActorsWithSaveTags, const FString& LoadOnlyStreamingLevel)
+{
+	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Streaming Levels Filter <3 Rama
+	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	 
 	//Is this actor in the requested streaming level?
 	if(LoadOnlyStreamingLevel != "" && LoadOnlyStreamingLevel != "Old File Version, Re-save this file to get level streaming info! <3 Rama")
 	{ 
 		//Not Match?
-		if(LoadOnlyStreamingLevel != LoadedLevelPackageName)
+		if(LoadOnlyStreamingLevel != Record.LevelPackageName)
 		{
-			//Skip! Essential to maintain integrity of load process!
-			Ar.Seek(ActorArchiveEndPos);
-			 
-			return true;
+			return false;
 		}
 	}
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	
-	
 	//Does this actor archive entry contains any of the tags needed?
 	if(LoadActorsWithSaveTags.Num() > 0)
 	{
-		bool SaveTagMatch = false;
 		for(const FString& EachSuppliedTag : LoadActorsWithSaveTags)
 		{
-			if(!TempTags.Contains(EachSuppliedTag)) continue;
-			 
-			//Match!
-			SaveTagMatch = true;
-			break;
+			if(Record.SaveTags.Contains(EachSuppliedTag))
+			{
+				//Match!
+				return true;
+			}
 		}
-		 
-		if(!SaveTagMatch)
+		return false;
+	}
+	
+	return true;
+}
+
+//This is Static
+UClass* URamaSaveComponent::ResolveActorClass(const FRamaSaveActorRecord& Record)
+{
+	const FString& ActorClassFromFile = Record.ActorClass;
+	const FString& ActorClassFullPath = Record.ActorClassFullPath;
+	
+	//Already in memory (the load preloads it), exact path so no search of every package
+	UClass* LoadedActorOwnerClass = ActorClassFullPath.IsEmpty() ? nullptr : FindObject<UClass>(nullptr, *ActorClassFullPath);
+	if(LoadedActorOwnerClass)
+	{
+		return LoadedActorOwnerClass;
+	}
+	
+	//Get the Class Name!
+	LoadedActorOwnerClass = FindObject<UClass>(ANY_PACKAGE, *ActorClassFromFile);
+	if(LoadedActorOwnerClass == NULL)
+	{
+		LoadedActorOwnerClass = LoadObject<UClass>(NULL, *ActorClassFromFile);
+	}
+
+	//Check Class
+	if(LoadedActorOwnerClass == NULL)
+	{ 
+		UE_LOG(RamaSave, Warning,TEXT("Actor Class not found, loading from full class path... %s"), *ActorClassFromFile );
+		
+		//Load Static Class
+		//		This works where the FindObject/LoadObject code pattern fails!
+		LoadedActorOwnerClass = LoadClassFromPath(ActorClassFullPath);  
+		//Note that StaticLoadClass expects as a UObject superclass, like UObject::StaticClass() or AActor::StaticClass() as the base class     
+		
+		if(LoadedActorOwnerClass == NULL)
 		{
-			//Skip! Essential to maintain integrity of load process!
-			Ar.Seek(ActorArchiveEndPos);
-			
-			return true;
+			UE_LOG(RamaSave, Error,TEXT("Actor Class not found, was it removed? %s"), *ActorClassFullPath );
+		}
+		else
+		{   
+			UE_LOG(RamaSave, Warning,TEXT(">>>> SUCCESS: Actor successfully loaded from full class path! ~ %s"), *ActorClassFullPath);
 		}
 	}
+	return LoadedActorOwnerClass;
+}
+
+//This is Static
+bool URamaSaveComponent::RamaSave_LoadFromRecord(UWorld* World, const FRamaSaveActorRecord& Record, FRamaSaveArchive &Ar, URamaSaveComponent*& LoadedComp, bool DontLoadPlayerPawns, TMap<FString, UClass*>* ClassCache)
+{
+	URamaSaveSystemSettings* Settings = URamaSaveSystemSettings::Get();
+	if(!Settings) 
+	{
+		UE_LOG(RamaSave, Error,TEXT("URamaSaveComponent::RamaSave_LoadFromRecord>> Huge big error! Tell Rama!"));
+		return false;
+	}
+	
+	bool GlobalLogging = Settings->Loading_GlobalVerboseLogging;
+	
+	LoadedComp = nullptr;
+	
+	const FString& ActorClassFullPath = Record.ActorClassFullPath;
+	const FGuid& PersistentActorUniqueID = Record.PersistentActorUniqueID;
+	const int64 ActorArchiveEndPos = Record.RecordEnd;
+	
+	//Records may be applied in any order, go to this one's properties
+	Ar.Seek(Record.PropertiesBegin);
 	
 	AActor* NewActor = nullptr;
 	 
 	//Doing lookup or creating new?
 	if(PersistentActorUniqueID.IsValid())
 	{
-		for(TObjectIterator<URamaSaveComponent> Itr; Itr; ++Itr)
+		//Only components registered in this World <3 Rama
+		FRamaSaveRegistry* Registry = FRamaSaveRegistry::Find(World);
+		if(URamaSaveComponent* Found = Registry ? Registry->FindByGuid(PersistentActorUniqueID) : nullptr)
 		{
-			//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-			//     World must match <3 Rama
-			if(Itr->GetWorld() != World) continue;
-			//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-			
-			if(Itr->RamaSave_PersistentActorUniqueID == PersistentActorUniqueID)
+			NewActor = Found->GetOwner();
+			if(!NewActor)
 			{
-				NewActor = Itr->GetOwner();
-				if(!NewActor)
-				{
-					UE_LOG(RamaSave, Error,TEXT("Component with FGUID found, but GetOwner() returned nullptr!!!!!! %s %s"), *PersistentActorUniqueID.ToString(), *Itr->GetName() );
-				}
-				else
-				{
-					if(Itr->RamaSave_LogPersistentActorGUID) UE_LOG(RamaSave, Warning, TEXT("Rama Save ~ Actor with GUID found and loaded! %s"), *Itr->RamaSave_PersistentActorUniqueID.ToString() );
-				}
-				break;
-				//~~~~
+				UE_LOG(RamaSave, Error,TEXT("Component with FGUID found, but GetOwner() returned nullptr!!!!!! %s %s"), *PersistentActorUniqueID.ToString(), *Found->GetName() );
+			}
+			else
+			{
+				if(Found->RamaSave_LogPersistentActorGUID) UE_LOG(RamaSave, Warning, TEXT("Rama Save ~ Actor with GUID found and loaded! %s"), *Found->RamaSave_PersistentActorUniqueID.ToString() );
 			}
 		}
 		
@@ -169,37 +293,28 @@ bool URamaSaveComponent::RamaSave_LoadFromFile(UWorld* World, int32 RamaSaveSyst
 	} 
 	else
 	{
-		//Get the Class Name!
-		UClass* LoadedActorOwnerClass = FindObject<UClass>(ANY_PACKAGE, *ActorClassFromFile);
-		if(LoadedActorOwnerClass == NULL)
+		//Each distinct class is resolved once per load
+		UClass* LoadedActorOwnerClass = nullptr;
+		if(UClass** Cached = ClassCache ? ClassCache->Find(ActorClassFullPath) : nullptr)
 		{
-			LoadedActorOwnerClass = LoadObject<UClass>(NULL, *ActorClassFromFile);
+			LoadedActorOwnerClass = *Cached;
 		}
-
-		//Check Class
-		if(LoadedActorOwnerClass == NULL)
-		{ 
-			UE_LOG(RamaSave, Warning,TEXT("Actor Class not found, loading from full class path... %s"), *ActorClassFromFile );
-			
-			//Load Static Class
-			//		This works where the FindObject/LoadObject code pattern fails!
-			LoadedActorOwnerClass = LoadClassFromPath(ActorClassFullPath);  
-			//Note that StaticLoadClass expects as a UObject superclass, like UObject::StaticClass() or AActor::StaticClass() as the base class     
-			
-			if(LoadedActorOwnerClass == NULL)
+		else
+		{
+			LoadedActorOwnerClass = ResolveActorClass(Record);
+			if(ClassCache)
 			{
-				UE_LOG(RamaSave, Error,TEXT("Actor Class not found, was it removed? %s"), *ActorClassFullPath );
-				
-				//Skip! Essential to maintain integrity of load process!
-				Ar.Seek(ActorArchiveEndPos);
-			
-				return false;
-			}
-			else
-			{   
-				UE_LOG(RamaSave, Warning,TEXT(">>>> SUCCESS: Actor successfully loaded from full class path! ~ %s"), *ActorClassFullPath);
+				ClassCache->Add(ActorClassFullPath, LoadedActorOwnerClass);
 			}
-		}  
+		}
+		
+		if(LoadedActorOwnerClass == NULL)
+		{
+			//Skip! Essential to maintain integrity of load process!
+			Ar.Seek(ActorArchiveEndPos);
+		
+			return false;
+		}
 		  
 		//Create New Actor
 		NewActor = SpawnBP<AActor>(World, LoadedActorOwnerClass, FVector::ZeroVector); 
@@ -240,7 +355,7 @@ bool URamaSaveComponent::RamaSave_LoadFromFile(UWorld* World, int32 RamaSaveSyst
 	LoadedComp = SaveComp;
 	
 	//Set Loaded Data
-	SaveComp->LevelPackageName = LoadedLevelPackageName;
+	SaveComp->LevelPackageName = Record.LevelPackageName;
 	 
 	if(SaveComp->RamaSave_VerboseLog || GlobalLogging)
 	{ 
@@ -249,7 +364,7 @@ bool URamaSaveComponent::RamaSave_LoadFromFile(UWorld* World, int32 RamaSaveSyst
 	 
 	//If user adds more tags during runtime based on custom logic, those tags should be re-loaded!
 	// (load of Self and subclass vars will probably also do this)
-	SaveComp->RamaSave_SaveTags = TempTags;
+	SaveComp->RamaSave_SaveTags = Record.SaveTags;
 	 
 	//Set the Load Settings Struct (currently just 1 bool)
 	SaveComp->DontLoadPlayerPawns = DontLoadPlayerPawns;
@@ -272,6 +387,9 @@ bool URamaSaveComponent::RamaSave_LoadFromFile(UWorld* World, int32 RamaSaveSyst
 	//~~~~~~~~~~~~~~~~~~~~~~~~
 	//~~~~~~~~~~~~~~~~~~~~~~~~
 	
+	//Tags came from the record and the saved component properties
+	SaveComp->RamaSave_SaveTagsChanged();
+	
 	return true;
 }
 
@@ -319,14 +437,25 @@ void URamaSaveComponent::RamaCPP_PreSave()
 	}
 }
 
-bool URamaSaveComponent::RamaSave_SaveToFile(UWorld* World, FArchive &Ar)
+bool URamaSaveComponent::RamaSave_SaveToFile(UWorld* World, FRamaSaveArchive &Ar)
 { 
 	if(!RamaSave_ShouldSaveActor)
 	{
 		//Actor is not being saved right now per user request.
 		return true;
 	}
-	 
+	
+	//Written right away, the values are read straight from the actor
+	FRamaSaveActorSnapshot Snapshot;
+	if(!TakeSnapshot(World, Snapshot))
+	{
+		return false;
+	}
+	return Snapshot.Write(Ar);
+}
+
+bool URamaSaveComponent::TakeSnapshot(UWorld* World, FRamaSaveActorSnapshot& Snapshot)
+{
 	AActor* ActorOwner = GetOwner();
 	if(!ActorOwner)
 	{ 
@@ -334,86 +463,323 @@ bool URamaSaveComponent::RamaSave_SaveToFile(UWorld* World, FArchive &Ar)
 		UE_LOG(RamaSave, Error,TEXT("Component without an owner! %s"),*GetName());
 		return false;
 	}
-
-	//! #4 Actor Byte Chunk Skip Position
-	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-	//							Actor Byte Chunk Start
-	int64 ActorArchiveStartPos = Ar.Tell();
-	int64 ActorArchiveEndPos = 0; 						
-	Ar << ActorArchiveEndPos;	//Set aside space to fill later
-	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	
-	//! #4 String Actor Class
+	URamaSaveSystemSettings* Settings = URamaSaveSystemSettings::Get();
+	if(!Settings) 
+	{
+		return false;
+	}
+	
 	//Save the Actor Class Name 
 	//		so that during load, Actor can be created and then data loaded from file
-	FString ActorOwnerClass = ActorOwner->GetClass()->GetName();
-	Ar << ActorOwnerClass;
-	 
-	//! #4 String Actor Class Path
-	FString ActorClassFullPath = GetClassPath(ActorOwner->GetClass()); 
-	Ar << ActorClassFullPath;	
+	Snapshot.ActorName = ActorOwner->GetName();
+	Snapshot.ActorClass = ActorOwner->GetClass()->GetName();
+	Snapshot.ActorClassFullPath = GetClassPath(ActorOwner->GetClass()); 
 	
 	if(RamaSave_VerboseLog)
 	{ 
-		UE_LOG(RamaSave, Warning,TEXT("Saving Actor class path %s"), *ActorClassFullPath);
+		UE_LOG(RamaSave, Warning,TEXT("Saving Actor class path %s"), *Snapshot.ActorClassFullPath);
 	}
 	
-	//! #4.5 FGUID !
-	Ar << RamaSave_PersistentActorUniqueID;
-	
-	//! 4.7333 Actor Tags
-	Ar << RamaSave_SaveTags;
-	
 	//Set the Level Package Name, so that can filter when loading if that is desired
 	LevelPackageName = GetActorStreamingLevelPackageName();
 	
-	//! 4.9 Level Streaming
-	Ar << LevelPackageName;
+	//Tags written to the file are the ones queries see
+	RamaSave_SaveTagsChanged();
+	
+	Snapshot.PersistentActorUniqueID = RamaSave_PersistentActorUniqueID;
+	Snapshot.SaveTags = RamaSave_SaveTags;
+	Snapshot.LevelPackageName = LevelPackageName;
 	
 	//~~~~~~~~~~~~~~~~~~~~~~~~
-	//~~~~~~~~~~~~~~~~~~~~~~~~
-	//~~~~~~~~~~~~~~~~~~~~~~~~
-	//! #5 Serialize Properties
-	SaveSelfAndSubclassVariables(Ar);
-	SaveOwnerVariables(World,Ar); 									//Actor Transform
+	//! #5 Properties
+	SnapshotSelfAndSubclassVariables(Snapshot);
+	SnapshotOwnerVariables(World, Snapshot); 								//Actor Transform
 	
 	if(RamaSave_SavePhysicsData)
 	{
-		SaveOwnerVariables_Physics(ActorOwner, World,Ar);		//Physics
+		SnapshotOwnerVariables_Physics(ActorOwner, Snapshot);			//Physics
 	}
 	
-	SaveSubComponentVariables(ActorOwner, World,Ar);
-	//~~~~~~~~~~~~~~~~~~~~~~~~
+	SnapshotSubComponentVariables(ActorOwner, Snapshot);
 	//~~~~~~~~~~~~~~~~~~~~~~~~
-	//~~~~~~~~~~~~~~~~~~~~~~~~
-		    
-	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-	//								Actor Byte Chunk End
-	ActorArchiveEndPos = Ar.Tell();	//End of all actor bytes
-	Ar.Seek(ActorArchiveStartPos);	//Go back
-	Ar << ActorArchiveEndPos;			//Record the number of bytes
-	Ar.Seek(ActorArchiveEndPos);	// go back to end!
-	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	
 	return true;
 }
 
+//Name, then the value as a sized blob so loading can skip properties that no longer exist
+//	With property layouts the name is in the block's layout
+void URamaSaveComponent::SaveProperty(FRamaSaveArchive &Ar, UProperty* Property, void* Container)
+{
+	SavePropertyAt(Ar, Property, Property->ContainerPtrToValuePtr<uint8>(Container));
+}
+void URamaSaveComponent::SavePropertyAt(FRamaSaveArchive &Ar, UProperty* Property, uint8* ValuePtr)
+{
+	if(!Ar.Layouts)
+	{
+		FName PropertyName = Property->GetFName();
+		Ar.SerializeName(PropertyName);
+	}
+	
+	//We want each property as pure binary data 
+	//		so we can easily save it to disk and not worry about its exact type!
+	Ar.SaveSized([&](FRamaSaveArchive& PropertyAr)
+	{
+		SavePropertyValue(PropertyAr, Property, ValuePtr);
+	});
+}
 
-void URamaSaveComponent::SaveOwnerVariables(UWorld* World, FArchive &Ar)
+//Numbers, enums and a few engine structs made only of numbers are the same bytes in memory and on disk.
+//	Plain old data is not enough, object pointers and FNames are plain old data too but only mean something in this process
+bool URamaSaveComponent::IsRawProperty(UProperty* Property)
 {
-	URamaSaveSystemSettings* Settings = URamaSaveSystemSettings::Get();
-	if(!Settings) 
+	if(Property->IsA(UNumericProperty::StaticClass()) || Property->IsA(UEnumProperty::StaticClass()))
+	{
+		return true;
+	}
+	
+	UStructProperty* StructProperty = Cast<UStructProperty>(Property);
+	if(!StructProperty)
 	{
+		return false;
+	}
+	
+	static const TSet<UScriptStruct*> RawStructs = {
+		TBaseStructure<FVector>::Get(),
+		TBaseStructure<FVector2D>::Get(),
+		TBaseStructure<FVector4>::Get(),
+		TBaseStructure<FRotator>::Get(),
+		TBaseStructure<FQuat>::Get(),
+		TBaseStructure<FTransform>::Get(),
+		TBaseStructure<FColor>::Get(),
+		TBaseStructure<FLinearColor>::Get(),
+		TBaseStructure<FGuid>::Get(),
+		TBaseStructure<FIntPoint>::Get(),
+		TBaseStructure<FIntVector>::Get(),
+		TBaseStructure<FBox>::Get(),
+		TBaseStructure<FBox2D>::Get()
+	};
+	return RawStructs.Contains(StructProperty->Struct);
+}
+
+//Raw properties and arrays of them as raw bytes (JOY_SAVE_VERSION_RAWVALUES+), everything else through the property
+void URamaSaveComponent::SavePropertyValue(FRamaSaveArchive &Ar, UProperty* Property, uint8* ValuePtr)
+{
+	if(IsRawProperty(Property))
+	{
+		Ar.Serialize(ValuePtr, Property->ElementSize);
 		return;
 	}
 	
-	AActor* ActorOwner = GetOwner();
+	UArrayProperty* ArrayProperty = Cast<UArrayProperty>(Property);
+	if(ArrayProperty && IsRawProperty(ArrayProperty->Inner))
+	{
+		FScriptArrayHelper Helper(ArrayProperty, ValuePtr);
+		int32 Num = Helper.Num();
+		Ar << Num;
+		Ar.Serialize(Helper.GetRawPtr(), int64(Num) * ArrayProperty->Inner->ElementSize);
+		return;
+	}
+	
+	Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(), ValuePtr);
+}
+void URamaSaveComponent::LoadPropertyValue(FRamaSaveArchive &Ar, UProperty* Property, uint8* ValuePtr, int64 EndPos)
+{
+	if(Ar.bRawValues)
+	{
+		if(IsRawProperty(Property))
+		{
+			//Size check, the type can have changed since the file was written
+			if(EndPos - Ar.Tell() != Property->ElementSize)
+			{
+				UE_LOG(RamaSave, Warning, TEXT("Property size in save file does not match the class, not loaded %s %s"), *Property->GetOwnerClass()->GetName(), *Property->GetName());
+				Ar.Seek(EndPos);
+				return;
+			}
+			Ar.Serialize(ValuePtr, Property->ElementSize);
+			return;
+		}
+		
+		UArrayProperty* ArrayProperty = Cast<UArrayProperty>(Property);
+		if(ArrayProperty && IsRawProperty(ArrayProperty->Inner))
+		{
+			int32 Num = 0;
+			Ar << Num;
+			
+			const int64 Bytes = int64(Num) * ArrayProperty->Inner->ElementSize;
+			if(Num < 0 || EndPos - Ar.Tell() != Bytes)
+			{
+				UE_LOG(RamaSave, Warning, TEXT("Array size in save file does not match the class, not loaded %s %s"), *Property->GetOwnerClass()->GetName(), *Property->GetName());
+				Ar.Seek(EndPos);
+				return;
+			}
+			
+			FScriptArrayHelper Helper(ArrayProperty, ValuePtr);
+			Helper.EmptyAndAddUninitializedValues(Num);
+			Ar.Serialize(Helper.GetRawPtr(), Bytes);
+			return;
+		}
+	}
+	
+	Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(), ValuePtr);
+}
 
-	//! #6 Total Count
-	//Serialize the total count, even if it is 0! 
-	int64 TotalProperties = 0;
-	int64 ArchiveBegin = Ar.Tell();		//cant assume starting at 0!
+//Delta saves, true if the value still matches the archetype (class default object for spawned actors)
+bool URamaSaveComponent::MatchesArchetype(UProperty* Property, UObject* Container)
+{
+	UObject* Archetype = Container->GetArchetype();
+	if(!Archetype || Archetype == Container || !Archetype->IsA(Property->GetOwnerClass()))
+	{
+		return false;
+	}
+	return Property->Identical_InContainer(Container, Archetype);
+}
+
+bool URamaSaveComponent::SavesOnlyChangedProperties() const
+{
+	return URamaSaveSystemSettings::Get()->SaveOnlyPropertiesChangedFromDefaults && !RamaSave_PersistentActorUniqueID.IsValid();
+}
+
+//Returns where the property ends, older files store it as an absolute int64
+int64 URamaSaveComponent::LoadPropertyHeader(FRamaSaveArchive &Ar, FName& PropertyName)
+{
+	Ar.SerializeName(PropertyName);
+	
+	if(Ar.bSizedRecords)
+	{
+		return Ar.LoadSizedEnd();
+	}
+	
+	int64 EndPosToSkip = 0;
+	Ar << EndPosToSkip;
+	return EndPosToSkip;
+}
+int64 URamaSaveComponent::LoadPropertyHeader(FRamaSaveArchive &Ar, const FRamaSaveLayout* Layout, int32 Ordinal, FName& PropertyName)
+{
+	if(!Layout)
+	{
+		return LoadPropertyHeader(Ar, PropertyName);
+	}
+	
+	PropertyName = Ar.Strings->Names[Layout->NameIndices[Ordinal]];
+	return Ar.LoadSizedEnd();
+}
+
+//Start of a property block, the count or with property layouts the layout index
+void URamaSaveComponent::SavePropertyBlockHeader(FRamaSaveArchive &Ar, TArrayView<UProperty* const> Properties)
+{
+	if(Ar.Layouts)
+	{
+		uint32 LayoutIndex = Ar.Layouts->Add(*Ar.Strings, Properties);
+		Ar.SerializeIntPacked(LayoutIndex);
+		return;
+	}
+	
+	int64 TotalProperties = Properties.Num();
+	Ar << TotalProperties;
+}
+const FRamaSaveLayout* URamaSaveComponent::LoadPropertyBlockHeader(FRamaSaveArchive &Ar, int64& TotalProperties)
+{
+	if(Ar.Layouts)
+	{
+		const FRamaSaveLayout* Layout = Ar.Layouts->Load(Ar);
+		TotalProperties = Layout ? Layout->NameIndices.Num() : 0;
+		return Layout;
+	}
+	
 	Ar << TotalProperties;
+	return nullptr;
+}
+
+//The properties of a block, into Container
+void URamaSaveComponent::LoadPropertyBlock(FRamaSaveArchive &Ar, const FRamaSaveLayout* Layout, int64 TotalProperties, UObject* Container)
+{
+	UClass* Class = Container->GetClass();
+	
+	if(Layout)
+	{
+		bool bMatches = false;
+		const TArray<UProperty*>& Properties = Ar.Layouts->Resolve(*Ar.Strings, *Layout, Class, bMatches);
+		
+		//Class has not changed since the file was written, apply by ordinal
+		if(bMatches)
+		{
+			for(UProperty* Property : Properties)
+			{
+				const int64 EndPos = Ar.LoadSizedEnd();
+				LoadPropertyValue(Ar, Property, Property->ContainerPtrToValuePtr<uint8>(Container), EndPos);
+			}
+			return;
+		}
+		
+		for(int32 v = 0; v < Properties.Num(); v++)
+		{
+			const int64 EndPosToSkip = Ar.LoadSizedEnd();
+			if(Properties[v])
+			{
+				LoadPropertyValue(Ar, Properties[v], Properties[v]->ContainerPtrToValuePtr<uint8>(Container), EndPosToSkip);
+			}
+			else
+			{
+				//SKIP TO END OF THIS PROPERTY AS IT WAS NOT FOUND IN ACTUAL CLASS
+				Ar.Seek(EndPosToSkip);
+			}
+		}
+		return;
+	}
+	
+	const FRamaSaveClassPlan& Plan = FRamaSaveClassPlan::Get(Class);
+	for(int64 v = 0; v < TotalProperties; v++)
+	{
+		//Get info about each property before deciding whether to serialize
+		FName PropertyName;
+		const int64 EndPosToSkip = LoadPropertyHeader(Ar, PropertyName);
+			
+		UProperty* Property = Plan.FindProperty(PropertyName);
+		if(Property) 
+		{ 
+			uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(Container);
+			
+			//Serialize Instance!
+			LoadPropertyValue(Ar, Property, InstanceValuePtr, EndPosToSkip);
+		}
+		else
+		{
+			//SKIP TO END OF THIS PROPERTY AS IT WAS NOT FOUND IN ACTUAL CLASS
+			// MUST HAVE BEEN REMOVED
+			Ar.Seek(EndPosToSkip);
+			 
+			UE_LOG(RamaSave,Warning,TEXT("Property in save file but not found in class, re-save to get rid of this message %s %s"), *Class->GetName(), *PropertyName.ToString());
+		}
+	}
+}
+
+
+void URamaSaveComponent::SnapshotOwnerVariables(UWorld* World, FRamaSaveActorSnapshot& Snapshot)
+{
+	URamaSaveSystemSettings* Settings = URamaSaveSystemSettings::Get();
+	AActor* ActorOwner = GetOwner();
+	
+	//!#9 Properties, gathered first so the total is known before writing
+	FRamaSavePropertyBlock& PropertiesToSave = Snapshot.Owner;
+	if(ActorOwner && (RamaSave_OwningActorVarsToSave.Num() > 0 || Settings->SaveAllPropertiesMarkedAsSaveGame))
+	{
+		const bool bOnlyChanged = SavesOnlyChangedProperties();
+		
+		//In the list of properties to save to disk, or marked SaveGame
+		FRamaSaveClassPlan& Plan = FRamaSaveClassPlan::Get(ActorOwner->GetClass());
+		for(UProperty* Property : Plan.GetSelection(RamaSave_OwningActorVarsToSave, Settings->SaveAllPropertiesMarkedAsSaveGame))
+		{
+			//Still the class default? Nothing to save
+			if(bOnlyChanged && MatchesArchetype(Property, ActorOwner))
+			{
+				continue;
+			}
+			PropertiesToSave.Add(Property, ActorOwner);
+		}
+	}
+
+	//! #6 Total Count, written even if it is 0!
 	
 	if(!ActorOwner) 
 	{ 
@@ -426,7 +792,7 @@ void URamaSaveComponent::SaveOwnerVariables(UWorld* World, FArchive &Ar)
 	APawn* Pawn = Cast<APawn>(ActorOwner);
 	if(Pawn)
 	{
-		SaveOwnerVariables_Pawn(Pawn,World,Ar);
+		SnapshotOwnerVariables_Pawn(Pawn, World, Snapshot);
 	}
 	 
 	//! #8 Physics
@@ -468,59 +834,10 @@ void URamaSaveComponent::SaveOwnerVariables(UWorld* World, FArchive &Ar)
 	#endif //WITH_EDITOR
 	 
 	//~~~ Diagnostic ~~~
-	  
-	//~~~~~~~~~~~~~~~~~~~~
-	if(RamaSave_OwningActorVarsToSave.Num() < 1 && !Settings->SaveAllPropertiesMarkedAsSaveGame) return;
-	//~~~~~~~~~~~~~~~~~~~~~~
-	
-	//!#9 Properties
-	for (TFieldIterator<UProperty> It(ActorOwner->GetClass()); It; ++It)
-	{
-		UProperty* Property = *It;
-		FString PropertyNameString = Property->GetFName().ToString();
-	    
-		//Is this property in the list of properties to save to disk?
-		if(RamaSave_OwningActorVarsToSave.Contains(PropertyNameString) || (Settings->SaveAllPropertiesMarkedAsSaveGame && Property->HasAnyPropertyFlags(CPF_SaveGame)))
-		{	
-			//We want each property as pure binary data 
-			//		so we can easily save it to disk and not worry about its exact type!
-			uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(ActorOwner);  //this = object instance that has this property!
-			
-			int64 StartAfterStringPos = 0; //Ar POSITION TO STORE THE END POS AT
-			int64 EndPos = 0; 						//Postion after serializing property
-			
-			//Serialize Instance of Property!
-			Ar << PropertyNameString;
-			StartAfterStringPos = Ar.Tell();
-			Ar << EndPos;
-			 
-			//Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(),InstanceValuePtr); 
-			 
-			Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(), InstanceValuePtr);
-			
-			EndPos = Ar.Tell();
-			Ar.Seek(StartAfterStringPos);
-			Ar << EndPos;
-			Ar.Seek(EndPos);
-			
-			TotalProperties++;
-		} 
-	}  
-	
-	//Put the total at the beginning of archive so know how big of for loop to amke
-	const int64 ArchiveEnd = Ar.Tell();
-	Ar.Seek(ArchiveBegin);
-	Ar << TotalProperties;
-	
-	//Move back to end of archive 
-	//		so as to not ovewrite all data 
-	//			when next archive entries occur!!
-	Ar.Seek(ArchiveEnd); //<~~~ !
 }
-void URamaSaveComponent::SaveOwnerVariables_Pawn(APawn* Pawn, UWorld* World, FArchive &Ar)
+void URamaSaveComponent::SnapshotOwnerVariables_Pawn(APawn* Pawn, UWorld* World, FRamaSaveActorSnapshot& Snapshot)
 {
 	bool IsPlayer = Pawn->GetPlayerState() != nullptr;
-	Ar << IsPlayer;
 	   
 	FVector PawnVelocity = FVector::ZeroVector;
 	if(Pawn->GetMovementComponent() != nullptr)
@@ -532,15 +849,12 @@ void URamaSaveComponent::SaveOwnerVariables_Pawn(APawn* Pawn, UWorld* World, FAr
 		//VSCREENMSG2("Rama Save Component SAVING ~ Movement component was invalid for", Pawn->GetName());
 		//UE_LOG(RamaSave,Warning,TEXT("Rama Save Component SAVING ~ Movement component was invalid for %s"), *Pawn->GetName());
 	}
-	Ar << PawnVelocity; 
-	
 	
 	FRotator ControlRotation = Pawn->GetControlRotation();
 	if(Pawn->GetController())
 	{
 		ControlRotation = Pawn->GetController()->GetControlRotation(); //For symmetry, could use Pawn::GetControlRotation but there's no Set
 	}
-	Ar << ControlRotation; 
 	
 	int32 PlayerIndex = -1; //Indicates its a non-player controlled unit
 	if(IsPlayer)
@@ -555,54 +869,39 @@ void URamaSaveComponent::SaveOwnerVariables_Pawn(APawn* Pawn, UWorld* World, FAr
 	}  
 	 
 	//Always Serializing, -1 for non players
-	Ar << PlayerIndex;
+	Snapshot.bPawn = true;
+	Snapshot.bIsPlayer = IsPlayer;
+	Snapshot.PawnVelocity = PawnVelocity;
+	Snapshot.ControlRotation = ControlRotation;
+	Snapshot.PlayerIndex = PlayerIndex;
 }
-void URamaSaveComponent::SaveOwnerVariables_Physics(AActor* ActorOwner, UWorld* World, FArchive &Ar)
+void URamaSaveComponent::SnapshotOwnerVariables_Physics(AActor* ActorOwner, FRamaSaveActorSnapshot& Snapshot)
 {
 	TArray<UPrimitiveComponent*> PrimComps;
 	ActorOwner->GetComponents<UPrimitiveComponent>(PrimComps);
 	
-	//Whether this file has any Physics save data
-	bool HavePhysicsSaveData = true;
-	Ar << HavePhysicsSaveData;
-	
-	//Save count, so if count doesnt match, know to skip section
-	int32 PrimitiveCount = PrimComps.Num();
-	int64 SkipIndex = 0;
-	int64 SkipLocation = 0;
-	Ar << PrimitiveCount;
-	SkipLocation = Ar.Tell();
-	Ar << SkipIndex;
-	
-	//Save RB States
+	Snapshot.bPhysics = true;
 	for(UPrimitiveComponent* Each : PrimComps)
 	{
 		bool IsSimulatingPhysics = Each->IsSimulatingPhysics();
-		Ar << IsSimulatingPhysics;
+		Snapshot.Simulating.Add(IsSimulatingPhysics);
 		
 		//Dont save RB state for every primitive comp in the world!
 		if(IsSimulatingPhysics)
 		{ 
-			FRBSave PhysState;
+			FRBSave& PhysState = Snapshot.PhysStates[Snapshot.PhysStates.AddDefaulted()];
 			PhysState.FillFrom(Each);			//Not concerned about multiple bone setups, just root bone for the time being
-			Ar << PhysState;
 		}
 	}
-	  
-	int64 EndIndex = Ar.Tell();
-	Ar.Seek(SkipLocation);
-	SkipIndex = EndIndex;
-	Ar << SkipIndex;
-	Ar.Seek(EndIndex);
 }
 	
-void URamaSaveComponent::LoadOwnerVariables(UWorld* World, FArchive &Ar)
+void URamaSaveComponent::LoadOwnerVariables(UWorld* World, FRamaSaveArchive &Ar)
 { 
 	AActor* ActorOwner = GetOwner();
 	
 	//! #6 Total Count
 	int64 TotalProperties = 0;
-	Ar << TotalProperties;
+	const FRamaSaveLayout* Layout = LoadPropertyBlockHeader(Ar, TotalProperties);
 	
 	//Has to be Valid
 	check(ActorOwner);
@@ -618,31 +917,7 @@ void URamaSaveComponent::LoadOwnerVariables(UWorld* World, FArchive &Ar)
 	//
 	  
 	//!#9 Properties
-	for(int64 v = 0; v < TotalProperties; v++)
-	{
-		//Get info about each property before deciding whether to serialize
-		FString PropertyNameString;
-		int64 EndPosToSkip;
-		Ar << PropertyNameString;
-		Ar << EndPosToSkip; 
-			
-		UProperty* Property = FindField<UProperty>( ActorOwner->GetClass(), *PropertyNameString );
-		if(Property) 
-		{ 
-			uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(ActorOwner);  //this = object instance that has this property!
-			
-			//Serialize Instance!
-			Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(),InstanceValuePtr);
-		}
-		else
-		{
-			//SKIP TO END OF THIS PROPERTY AS IT WAS NOT FOUND IN ACTUAL CLASS
-			// MUST HAVE BEEN REMOVED
-			Ar.Seek(EndPosToSkip);
-			 
-			UE_LOG(RamaSave,Warning,TEXT("Property in save file but not found in class, re-save to get rid of this message %s %s"), *ActorOwner->GetClass()->GetName(), *PropertyNameString);
-		}
-	}
+	LoadPropertyBlock(Ar, Layout, TotalProperties, ActorOwner);
 }
 void URamaSaveComponent::LoadOwnerVariables_Pawn(APawn* Pawn, UWorld* World, FArchive &Ar)
 {
@@ -726,7 +1001,7 @@ void URamaSaveComponent::LoadOwnerVariables_Pawn(APawn* Pawn, UWorld* World, FAr
 		UE_LOG(RamaSave,Warning,TEXT("Rama Save Component LOADING ~ Movement component was invalid for %s"), *Pawn->GetName());
 	}
 }
-void URamaSaveComponent::LoadOwnerVariables_Physics(AActor* ActorOwner, UWorld* World, FArchive &Ar)
+void URamaSaveComponent::LoadOwnerVariables_Physics(AActor* ActorOwner, UWorld* World, FRamaSaveArchive &Ar)
 {
 	TArray<UPrimitiveComponent*> PrimComps;
 	ActorOwner->GetComponents<UPrimitiveComponent>(PrimComps);
@@ -743,7 +1018,14 @@ void URamaSaveComponent::LoadOwnerVariables_Physics(AActor* ActorOwner, UWorld*
 	int32 PrimitiveCount = 0;
 	int64 SkipIndex = -1;
 	Ar << PrimitiveCount;
-	Ar << SkipIndex;
+	if(Ar.bSizedRecords)
+	{
+		SkipIndex = Ar.LoadSizedEnd();
+	}
+	else
+	{
+		Ar << SkipIndex;
+	}
 	
 	//Save file has Physics data but user does not want to load it.
 	if(!RamaSave_SavePhysicsData)
@@ -843,127 +1125,43 @@ void URamaSaveComponent::PhysicsTimer()
 	} 
 }
 	
-void URamaSaveComponent::SaveSelfAndSubclassVariables(FArchive &Ar)
+void URamaSaveComponent::SnapshotSelfAndSubclassVariables(FRamaSaveActorSnapshot& Snapshot)
 {
+	const bool bOnlyChanged = SavesOnlyChangedProperties();
+	
 	//Transform
 	OwningActorTransform = GetOwner()->GetTransform();
 	
 	//~~~
 	
-	//Get superclass to compare with to ensure dont serialize properties belonging to base class
-	UClass* SuperClass = Super::StaticClass();
-	 
-	//Serialize the total count, even if it is 0! 
-	int64 TotalProperties = 0;
-	int64 ArchiveBegin = Ar.Tell();		//cant assume starting at 0!
-	Ar << TotalProperties;
-	
-	for (TFieldIterator<UProperty> It(this->GetClass()); It; ++It)
+	//Properties the user added in subclasses, not the ones from the base class
+	//Gathered first so the total is known before writing
+	FRamaSavePropertyBlock& PropertiesToSave = Snapshot.Self;
+	for(UProperty* Property : FRamaSaveClassPlan::Get(GetClass()).GetComponentProperties())
 	{
-		UProperty* Property = *It;
-		FString PropertyNameString = Property->GetFName().ToString();
-  
-		//Delegate? 
-		if(Property->IsA(UMulticastDelegateProperty::StaticClass()))
-		{
-			//Dont serialize Delegates! (It breaks them)
-			continue;
-		}  
-		
-		//The Uber Graph Frame
-		if(PropertyNameString.Contains("UberGraphFrame"))
+		//Still the class default? Nothing to save, the transform is always needed to place the actor
+		if(bOnlyChanged && Property->GetFName() != GET_MEMBER_NAME_CHECKED(URamaSaveComponent, OwningActorTransform) && MatchesArchetype(Property, this))
 		{
 			continue;
 		}
-		 
-		//Is this property not in super class? Then the user added it, so save it!
-		UProperty* SuperClassProperty = FindField<UProperty>( SuperClass, *PropertyNameString );
-		if (!SuperClassProperty)
-		{ 
-			//Here's how to check if something is being saved that shouldn't be
-			if(RamaSave_LogAllSavedComponentProperties)
-			{
-				UE_LOG(RamaSave, Log, TEXT("%s ~ Serializing Save Component Property: %s"), *GetOwner()->GetName(), *PropertyNameString);
-			}  
-			 
-			/*
-			//what is the type of uber graph?
-			if(PropertyNameString.Contains("Uber"))
-			{
-				V_LOG2(RamaSave, "Type of Ubergraph", Property->GetClass()->GetName());
-			} 
-			*/
-			 
-			
-			//We want each property as pure binary data 
-			//		so we can easily save it to disk and not worry about its exact type!
-			uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(this);  //this = object instance that has this property!
-			
-			int64 StartAfterStringPos = 0; //Ar POSITION TO STORE THE END POS AT
-			int64 EndPos = 0; 						//Postion after serializing property
-			
-			//Serialize Instance of Property!
-			Ar << PropertyNameString;
-			StartAfterStringPos = Ar.Tell();
-			Ar << EndPos;
-			 
-			Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(),InstanceValuePtr); 
-			
-			EndPos = Ar.Tell();
-			Ar.Seek(StartAfterStringPos);
-			Ar << EndPos;
-			Ar.Seek(EndPos);
-			
-			TotalProperties++;
-		} 
-		/*
-		else
+		
+		//Here's how to check if something is being saved that shouldn't be
+		if(RamaSave_LogAllSavedComponentProperties)
 		{
-			V_LOG2(RamaSave,"Super class component property found and skipped", *PropertyNameString);
-		}
-		*/
+			UE_LOG(RamaSave, Log, TEXT("%s ~ Serializing Save Component Property: %s"), *GetOwner()->GetName(), *Property->GetName());
+		}  
+		
+		PropertiesToSave.Add(Property, this);  //this = object instance that has this property!
 	} 
-	 
-	//Put the total at the beginning of archive so know how big of for loop to amke
-	const int64 ArchiveEnd = Ar.Tell();
-	Ar.Seek(ArchiveBegin);
-	Ar << TotalProperties;
 	
-	//Move back to end of archive 
-	//		so as to not ovewrite all data 
-	//			when next archive entries occur!!
-	Ar.Seek(ArchiveEnd); //<~~~ !
+	//The total count (or layout) is written even if it is 0! 
 }
-void URamaSaveComponent::LoadSelfAndSubclassVariables(FArchive &Ar)
+void URamaSaveComponent::LoadSelfAndSubclassVariables(FRamaSaveArchive &Ar)
 {
 	int64 TotalProperties = 0;
-	Ar << TotalProperties;
-		
-	for(int64 v = 0; v < TotalProperties; v++)
-	{
-		//Get info about each property before deciding whether to serialize
-		FString PropertyNameString;
-		int64 EndPosToSkip;
-		Ar << PropertyNameString;
-		Ar << EndPosToSkip; 
-			
-		UProperty* Property = FindField<UProperty>( this->GetClass(), *PropertyNameString );
-		if(Property) 
-		{ 
-			uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(this);  //this = object instance that has this property!
-			
-			//Serialize Instance!
-			Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(),InstanceValuePtr);
-		}
-		else
-		{
-			//SKIP TO END OF THIS PROPERTY AS IT WAS NOT FOUND IN ACTUAL CLASS
-			// MUST HAVE BEEN REMOVED
-			Ar.Seek(EndPosToSkip);
-			 
-			UE_LOG(RamaSave,Warning,TEXT("Property in save file but not found in class, re-save to get rid of this message %s %s"), *GetClass()->GetName(), *PropertyNameString);
-		}
-	}
+	const FRamaSaveLayout* Layout = LoadPropertyBlockHeader(Ar, TotalProperties);
+	
+	LoadPropertyBlock(Ar, Layout, TotalProperties, this);  //this = object instance that has this property!
 	
 	//~~~ Transform ~~~
 	// This gets loaded above since it is UPROPERTY() in .h
@@ -994,13 +1192,10 @@ void URamaSaveComponent::LoadSelfAndSubclassVariables(FArchive &Ar)
 	}
 }
 
-void URamaSaveComponent::SaveSubComponentVariables(AActor* ActorOwner, UWorld* World, FArchive &Ar)
+void URamaSaveComponent::SnapshotSubComponentVariables(AActor* ActorOwner, FRamaSaveActorSnapshot& Snapshot)
 {
 	URamaSaveSystemSettings* Settings = URamaSaveSystemSettings::Get();
-	if(!Settings) 
-	{
-		return;
-	}
+	const bool bOnlyChanged = SavesOnlyChangedProperties();
 	
 	//Get All Actor Components
 	TArray<UActorComponent*> Comps;
@@ -1015,10 +1210,15 @@ void URamaSaveComponent::SaveSubComponentVariables(AActor* ActorOwner, UWorld* W
 	
 	//~~~ Comps with Vars that must have unique names in the string var list in old way ~~~
 	
-	//! Total
-	int64 TotalProperties = 0;
-	int64 ArchiveBegin = Ar.Tell();		//cant assume starting at 0!
-	Ar << TotalProperties;
+	//Gathered first so the total is known before writing
+	FRamaSavePropertyBlock& PropertiesToSave = Snapshot.SubComponents;
+	
+	//Property for each var name, per comp
+	TArray<const TArray<UProperty*>*, TInlineAllocator<16>> CompProperties;
+	for(UActorComponent* EachComp : Comps)
+	{
+		CompProperties.Add(&FRamaSaveClassPlan::Get(EachComp->GetClass()).GetNamedProperties(RamaSave_ComponentVarsToSave));
+	}
 	
 	//For each property to save
 	for(int32 v = 0; v < RamaSave_ComponentVarsToSave.Num(); v++)
@@ -1027,7 +1227,7 @@ void URamaSaveComponent::SaveSubComponentVariables(AActor* ActorOwner, UWorld* W
 		for(int32 b = 0; b < Comps.Num(); b++)
 		{
 			UActorComponent* EachComp = Comps[b];
-			UProperty* Property = FindField<UProperty>( EachComp->GetClass(), *EachToSave );
+			UProperty* Property = (*CompProperties[b])[v];
 			if(Property) 
 			{ 
 				if(RamaSave_LogAllSavedComponentProperties)
@@ -1035,26 +1235,11 @@ void URamaSaveComponent::SaveSubComponentVariables(AActor* ActorOwner, UWorld* W
 					UE_LOG(RamaSave,Warning,TEXT("Property found in component and saved to disk! %s %s %s"), *GetClass()->GetName(), *EachComp->GetName(), *EachToSave);
 				}	
 				 
-				//We want each property as pure binary data 
-				//		so we can easily save it to disk and not worry about its exact type!
-				uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(EachComp);  
-				
-				int64 StartAfterStringPos = 0; //Ar POSITION TO STORE THE END POS AT
-				int64 EndPos = 0; 						//Postion after serializing property
-				 
-				//Serialize Instance of Property!
-				Ar << EachToSave;
-				StartAfterStringPos = Ar.Tell();
-				Ar << EndPos;
-				 
-				Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(),InstanceValuePtr); 
-				
-				EndPos = Ar.Tell();
-				Ar.Seek(StartAfterStringPos);
-				Ar << EndPos;
-				Ar.Seek(EndPos);
-				
-				TotalProperties++;
+				//Still the class default? Nothing to save, but still the first match for this name
+				if(!(bOnlyChanged && MatchesArchetype(Property, EachComp)))
+				{
+					PropertiesToSave.Add(Property, EachComp);
+				}
 				 
 				//~~~~
 				//~~~~
@@ -1067,16 +1252,6 @@ void URamaSaveComponent::SaveSubComponentVariables(AActor* ActorOwner, UWorld* W
 		}
 	}
 	
-	//Put the total at the beginning of archive so know how big of for loop to amke
-	const int64 ArchiveEnd = Ar.Tell();
-	Ar.Seek(ArchiveBegin);
-	Ar << TotalProperties;
-	
-	//Move back to end of archive 
-	//		so as to not ovewrite all data 
-	//			when next archive entries occur!!
-	Ar.Seek(ArchiveEnd); //<~~~ !
-	
 	return;
 	} //Old Way
 	//=============== 
@@ -1084,13 +1259,8 @@ void URamaSaveComponent::SaveSubComponentVariables(AActor* ActorOwner, UWorld* W
 	
 
 	//~~~ Find All SaveGame Marked Properties in All Components ~~~
+	Snapshot.bSubComponentsPerComp = true;
 	
-	int64 SaveGameArchiveBegin = Ar.Tell();		//cant assume starting at 0!
-	
-	//#SC_1
-	int32 TotalCompEntries = 0;
-	Ar << TotalCompEntries;
-	  
 	for(int32 b = 0; b < Comps.Num(); b++)
 	{
 		UActorComponent* EachComp = Comps[b];
@@ -1100,115 +1270,28 @@ void URamaSaveComponent::SaveSubComponentVariables(AActor* ActorOwner, UWorld* W
 			continue;
 		}
 		
-		//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-		//Preliminary Scan to See if saving this comp <3 Rama
-		bool ShouldSave = false;
-		for (TFieldIterator<UProperty> It(EachComp->GetClass()); It; ++It)
+		//In the list of component vars to save, or marked SaveGame
+		FRamaSavePropertyBlock* Entry = nullptr;
+		for(UProperty* Property : FRamaSaveClassPlan::Get(EachComp->GetClass()).GetSelection(RamaSave_ComponentVarsToSave, true))
 		{
-			
-			UProperty* Property = *It;
-			FString PropertyNameString = Property->GetFName().ToString();
-			
-			if (RamaSave_ComponentVarsToSave.Contains(PropertyNameString) || Property->HasAnyPropertyFlags(CPF_SaveGame))
+			//Still the class default? Nothing to save
+			if(bOnlyChanged && MatchesArchetype(Property, EachComp))
 			{
-				ShouldSave = true;
-				TotalCompEntries++;
-				break;
+				continue;
 			}
-		}
-		//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-		
-		//Clean Skip
-		if(!ShouldSave) 
-		{  
-			//Don't store ANY info about comps that I am not saving
-			continue;
-		}
-		
-		
-		FString CompName = EachComp->GetName();
-		//#SC_2
-		Ar << CompName;
-		
-		
-		//~~~ might have to skip if comp removed ~~~
-		int64 SkipPos_Seek = Ar.Tell();
-		int64 SkipPos = 0;
-		//#SC_3
-		Ar << SkipPos;
-		
-		
-		int64 CompEntryBegin = Ar.Tell();
-		int32 CompPropertiesTotal = 0;
-		//#SC_4
-		Ar << CompPropertiesTotal;
-		
-		for (TFieldIterator<UProperty> It(EachComp->GetClass()); It; ++It)
-		{
-
-			UProperty* Property = *It;
-			FString PropertyNameString = Property->GetFName().ToString();
 			
-			if (RamaSave_ComponentVarsToSave.Contains(PropertyNameString) || Property->HasAnyPropertyFlags(CPF_SaveGame))
+			if(!Entry)
 			{
-				//Serialize Instance of Property!
-				//#SC_5
-				Ar << PropertyNameString;
-				int64 StartAfterPropertyStringPos = Ar.Tell();
-				
-				//#SC_6
-				int64 PropertyEndPos = 0; 						//Postion after serializing property
-				Ar << PropertyEndPos;
-
-				//#SC_7	
-				uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(EachComp);
-				Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(), InstanceValuePtr);
-
-				//~~~ Save End of Entry BEFORE going back ~~~
-				PropertyEndPos = Ar.Tell();
-				
-				Ar.Seek(StartAfterPropertyStringPos);
-				
-				Ar << PropertyEndPos;
-				Ar.Seek(PropertyEndPos);
-
-				CompPropertiesTotal++;
+				Entry = new(Snapshot.CompBlocks) FRamaSavePropertyBlock();
+				Snapshot.CompNames.Add(EachComp->GetFName());
 			}
+			Entry->Add(Property, EachComp);
 		}
 		
-		
-		//~~~ Update the total! ~~~
-		int64 CompEntryEnd = Ar.Tell();
-		Ar.Seek(CompEntryBegin);
-		Ar << CompPropertiesTotal;
-		
-		//~~~ Back to End! ~~~
-		Ar.Seek(CompEntryEnd);
-		
-		
-		//~~~ Store Skip Pos in case have to pass by a binary chunk for no longer existing comp ~~~
-	
-		//The skip position is our current position after serializing all data
-		SkipPos = Ar.Tell();
-		Ar.Seek(SkipPos_Seek);
-		Ar << SkipPos;
-		
-		//~~~ Back to current! ~~~
-		Ar.Seek(SkipPos);	
+		//Comps without any properties to save are not stored at all
 	}
-	
-	  
-	//~~~ Set Total! ~~~
-	const int64 SaveGameArchiveEnd = Ar.Tell();
-	Ar.Seek(SaveGameArchiveBegin);
-	Ar << TotalCompEntries;
-	 
-	//Move back to end of archive 
-	//		so as to not ovewrite all data 
-	//			when next archive entries occur!!
-	Ar.Seek(SaveGameArchiveEnd); //<~~~ !
 }
-void URamaSaveComponent::LoadSubComponentVariables(AActor* ActorOwner, UWorld* World, FArchive &Ar)
+void URamaSaveComponent::LoadSubComponentVariables(AActor* ActorOwner, UWorld* World, FRamaSaveArchive &Ar)
 {
 	URamaSaveSystemSettings* Settings = URamaSaveSystemSettings::Get();
 	if(!Settings) 
@@ -1228,36 +1311,40 @@ void URamaSaveComponent::LoadSubComponentVariables(AActor* ActorOwner, UWorld* W
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	{
 	int64 TotalProperties = 0;
-	Ar << TotalProperties;
+	const FRamaSaveLayout* Layout = LoadPropertyBlockHeader(Ar, TotalProperties);
 		
 	if(RamaSave_LogAllSavedComponentProperties)
 	{
 		UE_LOG(RamaSave,Warning,TEXT("Component Properties To Load: %s %d"), *GetClass()->GetName(), TotalProperties );
 	}
+	
+	TArray<const FRamaSaveClassPlan*, TInlineAllocator<16>> CompPlans;
+	for(UActorComponent* EachComp : Comps)
+	{
+		CompPlans.Add(&FRamaSaveClassPlan::Get(EachComp->GetClass()));
+	}
 				
 	for(int64 v = 0; v < TotalProperties; v++)
 	{ 
 		//Get info about each property before deciding whether to serialize
-		FString PropertyNameString;
-		int64 EndPosToSkip;
-		Ar << PropertyNameString;
-		Ar << EndPosToSkip; 
+		FName PropertyName;
+		const int64 EndPosToSkip = LoadPropertyHeader(Ar, Layout, v, PropertyName);
 		
 		bool Found = false;
 		for(int32 b = 0; b < Comps.Num(); b++)
 		{ 
 			UActorComponent* EachComp = Comps[b];
-			UProperty* Property = FindField<UProperty>( EachComp->GetClass(), *PropertyNameString );
+			UProperty* Property = CompPlans[b]->FindProperty(PropertyName);
 			if(Property) 
 			{ 
 				if(RamaSave_LogAllSavedComponentProperties)
 				{
-					UE_LOG(RamaSave,Warning,TEXT("Property found in component and loaded from disk! %s %s %s"), *GetClass()->GetName(), *EachComp->GetName(), *PropertyNameString);
+					UE_LOG(RamaSave,Warning,TEXT("Property found in component and loaded from disk! %s %s %s"), *GetClass()->GetName(), *EachComp->GetName(), *PropertyName.ToString());
 				}	
 				uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(EachComp);  //this = object instance that has this property!
 				
 				//Serialize Instance!
-				Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(),InstanceValuePtr);
+				LoadPropertyValue(Ar, Property, InstanceValuePtr, EndPosToSkip);
 				Found = true;
 				
 				//~~~~
@@ -1276,7 +1363,7 @@ void URamaSaveComponent::LoadSubComponentVariables(AActor* ActorOwner, UWorld* W
 			// MUST HAVE BEEN REMOVED
 			Ar.Seek(EndPosToSkip);
 			 
-			UE_LOG(RamaSave,Warning,TEXT("Property in save file but not found in class, re-save to get rid of this message %s %s"), *GetClass()->GetName(), *PropertyNameString);
+			UE_LOG(RamaSave,Warning,TEXT("Property in save file but not found in class, re-save to get rid of this message %s %s"), *GetClass()->GetName(), *PropertyName.ToString());
 		}
 	}
 	return;
@@ -1292,23 +1379,40 @@ void URamaSaveComponent::LoadSubComponentVariables(AActor* ActorOwner, UWorld* W
 	for(int32 v = 0; v < TotalCompEntries; v++)
 	{
 		//#SC_2
-		FString CompName;
-		Ar << CompName;
+		FName CompName;
+		Ar.SerializeName(CompName);
 		  
 		//#SC_3
 		int64 SkipPos;
-		Ar << SkipPos;
+		if(Ar.bSizedRecords)
+		{
+			SkipPos = Ar.LoadSizedEnd();
+		}
+		else
+		{
+			Ar << SkipPos;
+		}
 		 
 		
 		//#SC_4
-		int32 CompPropertiesTotal;
-		Ar << CompPropertiesTotal;
+		int64 CompPropertiesTotal = 0;
+		const FRamaSaveLayout* Layout = nullptr;
+		if(Ar.Layouts)
+		{
+			Layout = LoadPropertyBlockHeader(Ar, CompPropertiesTotal);
+		}
+		else
+		{
+			int32 LegacyTotal = 0;
+			Ar << LegacyTotal;
+			CompPropertiesTotal = LegacyTotal;
+		}
 		
 		//Find Comp
 		UActorComponent* FoundComponent = nullptr;
 		for(UActorComponent* Each : Comps)
 		{
-			if(Each && Each->GetName() == CompName)
+			if(Each && Each->GetFName() == CompName)
 			{
 				FoundComponent = Each;
 				break;
@@ -1318,44 +1422,19 @@ void URamaSaveComponent::LoadSubComponentVariables(AActor* ActorOwner, UWorld* W
 		//Verify Comp Exists!
 		if(!FoundComponent)
 		{
-			UE_LOG(RamaSave,Error,TEXT("Save data found for a component that no longer exists! %s"), *CompName);
+			UE_LOG(RamaSave,Error,TEXT("Save data found for a component that no longer exists! %s"), *CompName.ToString());
 			Ar.Seek(SkipPos);
 			continue;
 			//~~~~~~
 		}
-		 
-		for(int32 b = 0; b < CompPropertiesTotal; b++)
+		
+		if (RamaSave_LogAllSavedComponentProperties)
 		{
-			//Get info about each property before Loading it
-			FString PropertyNameString;
-			int64 EndPosToSkip;
-			//#SC_5
-			Ar << PropertyNameString;
-			//#SC_6
-			Ar << EndPosToSkip;
-
-			UProperty* Property = FindField<UProperty>(FoundComponent->GetClass(), *PropertyNameString);
-			if (Property)
-			{
-				if (RamaSave_LogAllSavedComponentProperties)
-				{
-					UE_LOG(RamaSave, Warning, TEXT("Property found in component and loaded from disk! %s %s %s"), *GetClass()->GetName(), *FoundComponent->GetName(), *PropertyNameString);
-				}
-				uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(FoundComponent);  //this = object instance that has this property!
-
-				//#SC_7																		  //Serialize Instance!
-				Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(), InstanceValuePtr);
-
-			}
-			else
-			{
-				//SKIP TO END OF THIS PROPERTY AS IT WAS NOT FOUND IN ACTUAL CLASS
-				// MUST HAVE BEEN REMOVED
-				Ar.Seek(EndPosToSkip);
-
-				UE_LOG(RamaSave, Warning, TEXT("Property in save file but not found in class, re-save to get rid of this message %s %s"), *GetClass()->GetName(), *PropertyNameString);
-			}
+			UE_LOG(RamaSave, Warning, TEXT("Properties found in component and loaded from disk! %s %s %lld"), *GetClass()->GetName(), *FoundComponent->GetName(), CompPropertiesTotal);
 		}
+		
+		//#SC_5 - #SC_7
+		LoadPropertyBlock(Ar, Layout, CompPropertiesTotal, FoundComponent);
 	} 
 	
 	
@@ -8,6 +8,12 @@
 
 #include "RamaSaveLibrary.h"
 #include "RamaSaveSystemSettings.h"
+#include "RamaSaveBlockArchive.h"
+#include "RamaSaveSectionFile.h"
+#include "RamaSaveSnapshot.h"
+
+#include "UObject/GarbageCollection.h"
+#include "ParallelFor.h"
 
 //////////////////////////////////////////////////////////////////////////
 // RamaSaveEngine
@@ -20,6 +26,10 @@ namespace RamaSaveCompressedTask
 {
 	FGraphEventArray		VictoryMultithreadTest_CompletionEvents;
 	
+	//Buffers handed back by finished tasks, collected by the engine for its pool
+	FCriticalSection		FinishedBuffersLock;
+	TArray<TArray<uint8>>	FinishedBuffers;
+	
 	//~~~~~~~~~~~~~~~
 	//Are All Tasks Complete?
 	//~~~~~~~~~~~~~~~
@@ -37,6 +47,16 @@ namespace RamaSaveCompressedTask
 		return true;
 	}
 	
+	//Before starting another save or a load, so files are never written out of order or read half written
+	void WaitForTasks()
+	{
+		if(VictoryMultithreadTest_CompletionEvents.Num() > 0)
+		{
+			FTaskGraphInterface::Get().WaitUntilTasksComplete(VictoryMultithreadTest_CompletionEvents);
+			VictoryMultithreadTest_CompletionEvents.Empty();
+		}
+	}
+	
 	//~~~~~~~~~~~
 	//Each Task Thread
 	//~~~~~~~~~~~
@@ -44,14 +64,20 @@ namespace RamaSaveCompressedTask
 	{
  
 	  public:
+		FRamaSaveFileSections Sections;
 		TArray<uint8> Data;
 		FString FileName = "";
-		FRamaSaveTask(const TArray<uint8>& BinaryData, const FString& InFileName) //send in property defaults here
+		ERamaSaveCodec Codec = ERamaSaveCodec::Zlib;
+		FRamaSaveWriteResultRef Result;
+		FRamaSaveTask(FRamaSaveFileSections&& InSections, TArray<uint8>&& BinaryData, const FString& InFileName, ERamaSaveCodec InCodec, const FRamaSaveWriteResultRef& InResult) //send in property defaults here
+			: Result(InResult)
 		{
-			//Copy entire buffer (switch to ptr if feeling bold)
-			Data = BinaryData;
+			//Take ownership of the buffers, no copy
+			Sections = MoveTemp(InSections);
+			Data = MoveTemp(BinaryData);
 			
 			FileName = InFileName;
+			Codec = InCodec;
 		}
  
 		/** return the name of the task **/
@@ -92,17 +118,162 @@ namespace RamaSaveCompressedTask
                 //~~~~~~~~~~~~~~~~~~~~~~~~
 		void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
 		{
-			URamaSaveUtility::CompressAndWriteToFile(Data,FileName);
+			Result->bSucceeded = URamaSaveUtility::WriteSectionedFile(FileName,Sections,Data,Codec);
+			Result->Size = Data.Num();
+			
+			FScopeLock Lock(&FinishedBuffersLock);
+			FinishedBuffers.Add(MoveTemp(Data));
+		}
+	};
+	
+	void Gooooo(FRamaSaveFileSections&& Sections, TArray<uint8>&& Data, const FString& File, ERamaSaveCodec Codec, const FRamaSaveWriteResultRef& Result)
+	{
+		VictoryMultithreadTest_CompletionEvents.Empty();
+		VictoryMultithreadTest_CompletionEvents.Add(TGraphTask<FRamaSaveTask>::CreateTask(NULL, ENamedThreads::GameThread).ConstructAndDispatchWhenReady(MoveTemp(Sections),MoveTemp(Data),File,Codec,Result));
+	}
+	
+	//~~~~~~~~~~~
+	//Save On Worker Thread, writes the actor records from snapshots, then the tables, compression and file
+	//~~~~~~~~~~~
+	class FRamaSaveEncodeTask
+	{
+	  public:
+		FRamaSaveSnapshotBatchPtr Snapshots;
+		FRamaSaveFileSections Sections;
+		TArray<uint8> Data;
+		FString FileName;
+		ERamaSaveCodec Codec;
+		bool bStreaming;
+		FRamaSaveWriteResultRef Result;
+		FRamaSaveEncodeTask(const FRamaSaveSnapshotBatchPtr& InSnapshots, FRamaSaveFileSections&& InSections, TArray<uint8>&& BinaryData, const FString& InFileName, ERamaSaveCodec InCodec, bool bInStreaming, const FRamaSaveWriteResultRef& InResult)
+			: Snapshots(InSnapshots)
+			, Sections(MoveTemp(InSections))
+			, Data(MoveTemp(BinaryData))
+			, FileName(InFileName)
+			, Codec(InCodec)
+			, bStreaming(bInStreaming)
+			, Result(InResult)
+		{
+		}
+		
+		static const TCHAR* GetTaskName()
+		{
+			return TEXT("FRamaSaveEncodeTask");
+		}
+		FORCEINLINE static TStatId GetStatId()
+		{
+			RETURN_QUICK_DECLARE_CYCLE_STAT(FRamaSaveEncodeTask, STATGROUP_TaskGraphTasks);
+		}
+		static ENamedThreads::Type GetDesiredThread()
+		{
+			return ENamedThreads::AnyThread;
+		}
+		static ESubsequentsMode::Type GetSubsequentsMode() 
+		{ 
+			return ESubsequentsMode::TrackSubsequents; 
+		}
+		
+		void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+		{
+			//Object paths were resolved on the game thread, the table only looks them up
+			FRamaSaveStringTable Strings;
+			Strings.ObjectPaths = &Snapshots->ObjectPaths;
+			
+			FRamaSaveLayoutTable Layouts;
+			bool AllRecordsWritten = true;
+			Result->bSucceeded = ARamaSaveEngine::WriteActorsFile(FileName, Sections, Data, Codec, bStreaming, Strings, Layouts, Snapshots->TotalComponents, Snapshots->Snapshots.Num(), [&](FRamaSaveArchive& Ar, int32 Index)
+			{
+				//Garbage collection waits only while copied values are read, never on compression or the write
+				FGCScopeGuard GCGuard;
+				const bool bWritten = Snapshots->Snapshots[Index].Write(Ar);
+				Snapshots->Snapshots[Index].DestroyValues();
+				return bWritten;
+			}, AllRecordsWritten);
+			Result->bAllRecordsWritten = AllRecordsWritten;
+			Result->Size = bStreaming ? -1 : Data.Num();
+			
+			{
+				//The game thread walks the snapshots when it reports references
+				FGCScopeGuard GCGuard;
+				Snapshots->Snapshots.Empty();
+			}
+			Snapshots.Reset();
+			
+			FScopeLock Lock(&FinishedBuffersLock);
+			FinishedBuffers.Add(MoveTemp(Data));
 		}
 	};
 	
-	void Gooooo(const TArray<uint8>& Data, const FString& File)
+	void GoooooEncode(const FRamaSaveSnapshotBatchPtr& Snapshots, FRamaSaveFileSections&& Sections, TArray<uint8>&& Data, const FString& File, ERamaSaveCodec Codec, bool bStreaming, const FRamaSaveWriteResultRef& Result)
 	{
 		VictoryMultithreadTest_CompletionEvents.Empty();
-		VictoryMultithreadTest_CompletionEvents.Add(TGraphTask<FRamaSaveTask>::CreateTask(NULL, ENamedThreads::GameThread).ConstructAndDispatchWhenReady(Data,File));
+		VictoryMultithreadTest_CompletionEvents.Add(TGraphTask<FRamaSaveEncodeTask>::CreateTask(NULL, ENamedThreads::GameThread).ConstructAndDispatchWhenReady(Snapshots,MoveTemp(Sections),MoveTemp(Data),File,Codec,bStreaming,Result));
 	}
 }
 
+//Load side, decompress and pre-parse while the game thread streams levels
+namespace RamaSaveDecodeTask
+{
+	class FRamaLoadTask
+	{
+	  public:
+		FRamaSaveDecodedFilePtr File;
+		FRamaSaveEngineParams Params;
+		FRamaLoadTask(const FRamaSaveDecodedFilePtr& InFile, const FRamaSaveEngineParams& InParams)
+			: File(InFile)
+			, Params(InParams)
+		{
+		}
+		
+		static const TCHAR* GetTaskName()
+		{
+			return TEXT("FRamaLoadTask");
+		}
+		FORCEINLINE static TStatId GetStatId()
+		{
+			RETURN_QUICK_DECLARE_CYCLE_STAT(FRamaLoadTask, STATGROUP_TaskGraphTasks);
+		}
+		static ENamedThreads::Type GetDesiredThread()
+		{
+			return ENamedThreads::AnyThread;
+		}
+		static ESubsequentsMode::Type GetSubsequentsMode() 
+		{ 
+			return ESubsequentsMode::FireAndForget; 
+		}
+		
+		void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+		{
+			//Sectioned file, the header is read on its own so Phase1 can start right away
+			TUniquePtr<FRamaSaveSectionReader> Sectioned(FRamaSaveSectionReader::OpenFile(File->FileName));
+			if(Sectioned.IsValid())
+			{
+				File->bValid = ARamaSaveEngine::ParseSectionedFile(*Sectioned, *File, Params);
+				File->bHeaderReady = true;
+				File->bFinished = true;
+				return;
+			}
+			
+			//Older files, mapped or streaming when the file allows it
+			File->FileReader.Reset(URamaSaveUtility::OpenFileReader(File->FileName, File->bStreaming));
+			
+			if(File->FileReader.IsValid())
+			{
+				File->bValid = ARamaSaveEngine::ParseDecodedFile(*File->FileReader, *File, Params);
+			}
+			else if(URamaSaveUtility::DecompressFromFile(File->FileName, File->Data))
+			{
+				FMemoryReader MemoryReader(File->Data, true);
+				File->bValid = ARamaSaveEngine::ParseDecodedFile(MemoryReader, *File, Params);
+			}
+			
+			//Even on failure, so the game thread stops waiting
+			File->bHeaderReady = true;
+			File->bFinished = true;
+		}
+	};
+}
+
 
 ARamaSaveEngine::ARamaSaveEngine(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -116,19 +287,83 @@ void ARamaSaveEngine::BeginPlay()
 	//~~~~~~~~~
 
 	UE_LOG(RamaSave, Log,TEXT("~~~ Rama Save Engine Created! ~~~"));
+	
+	MemoryTrimHandle = FCoreDelegates::GetMemoryTrimDelegate().AddUObject(this, &ARamaSaveEngine::TrimSaveBuffers);
 }
 void ARamaSaveEngine::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	//Clear the archive ptr <3 Rama
 	ClearAsyncArchive();
 	
+	//Snapshots still being written have to stay alive until they are
+	RamaSaveCompressedTask::WaitForTasks();
+	PendingSnapshots.Empty();
+	
+	//Free any decoded file of a load in progress
+	LoadDecodedFile.Reset();
+	
+	FCoreDelegates::GetMemoryTrimDelegate().Remove(MemoryTrimHandle);
+	TrimSaveBuffers();
+	
 	Super::EndPlay(EndPlayReason);
 }
 
 //~~~~~~~~~~~~~~~~~~~
 // 		SAVING
 //~~~~~~~~~~~~~~~~~~~
-void ARamaSaveEngine::RamaSave_SaveToFile(FString FileName, bool& FileIOSuccess, bool& AllComponentsSaved, FString SaveOnlyStreamingLevel, URamaSaveObject* StaticSaveData)
+void ARamaSaveEngine::TrimSaveBuffers()
+{
+	CollectFinishedSaveBuffers();
+	SaveBufferPool.Trim();
+}
+
+void ARamaSaveEngine::CollectFinishedSaveBuffers()
+{
+	FScopeLock Lock(&RamaSaveCompressedTask::FinishedBuffersLock);
+	for(TArray<uint8>& Each : RamaSaveCompressedTask::FinishedBuffers)
+	{
+		SaveBufferPool.Release(MoveTemp(Each));
+	}
+	RamaSaveCompressedTask::FinishedBuffers.Empty();
+	
+	//Only this engine holds them once their task is done
+	PendingSnapshots.RemoveAll([](const FRamaSaveSnapshotBatchPtr& Each)
+	{
+		return Each.IsUnique();
+	});
+}
+
+void ARamaSaveEngine::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	ARamaSaveEngine* This = CastChecked<ARamaSaveEngine>(InThis);
+	
+	//Encode tasks hold off garbage collection while writing, so the snapshots are not changing now
+	for(const FRamaSaveSnapshotBatchPtr& Each : This->PendingSnapshots)
+	{
+		Each->AddReferencedObjects(Collector);
+	}
+	if(This->RamaSaveAsync_Snapshots.IsValid())
+	{
+		This->RamaSaveAsync_Snapshots->AddReferencedObjects(Collector);
+	}
+	
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+void ARamaSaveEngine::StartEncodeTask(const FRamaSaveSnapshotBatchPtr& Snapshots, FRamaSaveFileSections&& Sections, TArray<uint8>&& ToBinary, const FString& FileName, ERamaSaveCodec Codec)
+{
+	PendingSnapshots.Add(Snapshots);
+	
+	FRamaSaveWriteResultRef Result = MakeShared<FRamaSaveWriteResult, ESPMode::ThreadSafe>();
+	PendingWriteResult = Result;
+	RamaSaveCompressedTask::GoooooEncode(Snapshots, MoveTemp(Sections), MoveTemp(ToBinary), FileName, Codec, URamaSaveSystemSettings::Get()->StreamingSaveLoad, Result);
+	
+	//Async_SaveFinished or Async_SaveFailed once the file is written
+	RamaSaveAsync_FileName = FileName;
+	SETTIMERH(TH_CheckCompressToFileFinished, ARamaSaveEngine::CheckCompressToFileFinished,0.01,true);
+}
+
+void ARamaSaveEngine::RamaSave_SaveToFile(FString FileName, bool& FileIOSuccess, bool& AllComponentsSaved, FString SaveOnlyStreamingLevel, URamaSaveObject* StaticSaveData, ERamaSaveCodec Codec)
 {
 	
 	 
@@ -138,6 +373,13 @@ void ARamaSaveEngine::RamaSave_SaveToFile(FString FileName, bool& FileIOSuccess,
 	ClearAsyncArchive();
 	//~~~~~~~~~~~~~~~~~~~
 	
+	//Previous save still being written on a worker thread, finished with its own file name
+	RamaSaveCompressedTask::WaitForTasks();
+	if(ISTIMERACTIVE(TH_CheckCompressToFileFinished))
+	{
+		CheckCompressToFileFinished();
+	}
+	
 	//~~~
 	
 	UWorld* World = GetWorld();
@@ -192,7 +434,7 @@ void ARamaSaveEngine::RamaSave_SaveToFile(FString FileName, bool& FileIOSuccess,
 	//ASYNC BRANCH
 	if(Settings->AsyncSave)
 	{
-		RamaSave_SaveToFile_ASYNC(FileName, FileIOSuccess, AllComponentsSaved, SaveOnlyStreamingLevel,StaticSaveData);
+		RamaSave_SaveToFile_ASYNC(FileName, FileIOSuccess, AllComponentsSaved, SaveOnlyStreamingLevel,StaticSaveData,Codec);
 		return;
 		//~~~~
 	}
@@ -209,6 +451,19 @@ void ARamaSaveEngine::RamaSave_SaveToFile(FString FileName, bool& FileIOSuccess,
 	
 	//! FILTER OUT ACTORS by STREAMING LEVEL HERE!
 	URamaSaveLibrary::GetAllRamaSaveComponents(World,RamaSaveComponents,SaveOnlyStreamingLevel);
+	
+	//Parallel Save, nothing runs during the save, so every comp is checked at once before any PreSave
+	const bool ParallelChecks = Settings->ParallelSave && Settings->Saving_PerformObjectValidityChecks;
+	if(ParallelChecks)
+	{
+		if(URamaSaveComponent* FailedComp = URamaSaveLibrary::VerifyAllActorAndComponentProperties(RamaSaveComponents))
+		{
+			AllComponentsSaved = false;
+			UE_LOG(RamaSave,Error,TEXT("Rama Save System ~ Cancelling ~ Actor vars could not be saved for %s"), *FailedComp->GetOwner()->GetName());
+			VSCREENMSG("Big big Save Error See Log!!!!!   <~~~~~    <~~~~    <~~~~");	
+			return;
+		}
+	}
 		
 	int32 CompCountNotBeingSaved = 0;
 	
@@ -228,7 +483,7 @@ void ARamaSaveEngine::RamaSave_SaveToFile(FString FileName, bool& FileIOSuccess,
 		
 	
 		//Verify all properties can be saved!
-		if(Settings->Saving_PerformObjectValidityChecks) //Might want to skip for faster saving
+		if(Settings->Saving_PerformObjectValidityChecks && !ParallelChecks) //Might want to skip for faster saving
 		{
 			if(!URamaSaveLibrary::VerifyActorAndComponentProperties(EachSaveComp))
 			{
@@ -282,131 +537,290 @@ void ARamaSaveEngine::RamaSave_SaveToFile(FString FileName, bool& FileIOSuccess,
 
 	//~~~
 	
+	const ERamaSaveCodec SaveCodec = URamaSaveUtility::ResolveCodec(Codec);
+	
+	//!#1 - #3 Header, Level Streaming, Static Data
+	FRamaSaveFileSections Sections;
+	SaveFileSections(World, StaticSaveData, Sections);
+	
 	//Have to create Archive at this level, and save the total number of components
 	//To then be loaded statically
-	TArray<uint8> ToBinary;
-	FMemoryWriter MemoryWriter(ToBinary, true);
+	CollectFinishedSaveBuffers();
+	TArray<uint8> ToBinary = SaveBufferPool.Acquire();
 	
-	//~~~ Versioning ~~~
-	
-	//! #1
+	//!#5 Component Total 
+	int32 TotalComponents = RamaSaveComponents.Num() - CompCountNotBeingSaved;
 	
-	// Write version for this file format
-	int32 SavegameFileVersion = JOY_SAVE_VERSION;
-	MemoryWriter << SavegameFileVersion;		//<~~~ Rama Custom Serialization Version
+	//Parallel Save
+	if(Settings->ParallelSave)
+	{
+		FileIOSuccess = RamaSave_SaveInParallel(World, FileName, Sections, ToBinary, SaveCodec, Settings->StreamingSaveLoad, TotalComponents, AllComponentsSaved);
+		
+		if(!Settings->StreamingSaveLoad)
+		{
+			SaveBufferPool.LastSaveSize = ToBinary.Num();
+		}
+		SaveBufferPool.Release(MoveTemp(ToBinary));
+		return;
+	}
 	
-	//! #2
-	 
-	// Write out engine and UE4 version information
-	int32 PackageFileUE4Version = GPackageFileUE4Version;
-	MemoryWriter << PackageFileUE4Version;
-	FEngineVersion SavedEngineVersion = FEngineVersion::Current();
-	MemoryWriter << SavedEngineVersion;
+	//!#6 Serialize All Comps!
+	FRamaSaveStringTable Strings;
+	FRamaSaveLayoutTable Layouts;
+	FileIOSuccess = WriteActorsFile(FileName, Sections, ToBinary, SaveCodec, Settings->StreamingSaveLoad, Strings, Layouts, TotalComponents, RamaSaveComponents.Num(), [&](FRamaSaveArchive& Ar, int32 Index)
+	{
+		URamaSaveComponent* EachSaveComp = RamaSaveComponents[Index];
+		
+		//FString LevelPackageName = EachSaveComp->GetActorStreamingLevelPackageName();
+		//RS_LOG2(RamaSave,"Saving Actor in package", LevelPackageName);
+		 
+		//! CAN NOW FILTER BASED ON PACKAGE NAME IF USER ONLY WANT SAVE PARTICULAR
+		
+		return EachSaveComp->RamaSave_SaveToFile(World,Ar);
+	}, AllComponentsSaved);
 	
+	if(!Settings->StreamingSaveLoad)
+	{
+		SaveBufferPool.LastSaveSize = ToBinary.Num();
+	}
+	SaveBufferPool.Release(MoveTemp(ToBinary));
+}
+
+bool ARamaSaveEngine::WriteActorsFile(const FString& FileName, FRamaSaveFileSections& Sections, TArray<uint8>& ToBinary, ERamaSaveCodec Codec, bool bStreaming, FRamaSaveStringTable& Strings, FRamaSaveLayoutTable& Layouts, int32 TotalComponents, int32 RecordCount, TFunctionRef<bool(FRamaSaveArchive&, int32)> WriteRecord, bool& AllRecordsWritten)
+{
+	FRamaSaveOffsetWriter MemoryWriter(ToBinary);
+	
+	//Streaming Save Load
+	//	ToBinary only ever holds one actor record, 
+	//	which is handed to the file a window of compressed blocks at a time
+	TUniquePtr<FRamaSaveSectionWriter> StreamFile;
+	FArchive* StreamWriter = nullptr;
+	if(bStreaming)
+	{
+		StreamFile.Reset(FRamaSaveSectionWriter::CreateFile(FileName));
+		if(!StreamFile.IsValid())
+		{
+			UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ File IO Error: Could not create file! %s"), *FileName);
+			return false;
+		}
+		StreamFile->WriteSection(RamaSaveSectionFile::Header, Sections.Header, Codec);
+		StreamFile->WriteSection(RamaSaveSectionFile::Streaming, Sections.Streaming, Codec);
+		StreamFile->WriteSection(RamaSaveSectionFile::StaticData, Sections.StaticData, Codec);
+		StreamWriter = &StreamFile->BeginSection(RamaSaveSectionFile::Actors, Codec);
+	}
+	auto FlushToStream = [&]()
+	{
+		if(!StreamWriter) return;
+		
+		StreamWriter->Serialize(ToBinary.GetData(), ToBinary.Num());
+		MemoryWriter.Rebase();
+	};
 	
-	//~~~ End Versioning ~~~
+	//Obj and Name as String, repeated strings go in the string table
+	FRamaSaveActorDirectory Directory;
+	FRamaSaveArchive Ar(MemoryWriter, false, &Strings);
+	Ar.Directory = &Directory;
+	Ar.Layouts = &Layouts;
 	
-	//Obj and Name as String
-	FObjectAndNameAsStringProxyArchive Ar(MemoryWriter, false);
+	//!#5 Component Total 
+	Ar << TotalComponents;
 	
-	//~~~
+	FlushToStream();
 	
-	//!#3 Level Streaming
-	TArray<FString> Streaming;
-	const TArray<ULevelStreaming*>& Levels = World->GetStreamingLevels();
-	for(ULevelStreaming* EachLevel : Levels)
+	//!#6 Actor Records
+	for(int32 Index = 0; Index < RecordCount; Index++)
 	{
-		if(!EachLevel) continue;
-		
-		FString NoPIELevelName = URamaSaveLibrary::RemoveLevelPIEPrefix(EachLevel->GetWorldAssetPackageName());
-		 
-		/*
-		//Only want to know about currently loaded and visible levels!
-		if(!EachLevel->IsLevelVisible()) 
+		if(!WriteRecord(Ar, Index))
 		{
-			RS_LOG2(RamaSave, "found NON VISIBLE streaming level", NoPIELevelName);
-			continue;
-		} 
-		RS_LOG2(RamaSave, "found visible streaming level", NoPIELevelName);
-	 	*/
+			AllRecordsWritten = false;
+		}
 		
-		//StreamingLevelName=Visible
-		Streaming.Add(NoPIELevelName + FString("=") + BOOLSTR(EachLevel->IsLevelVisible()));
+		FlushToStream();
 	}
-	Ar << Streaming;
 	
-	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-	//!#4 STATIC DATA
-	uint8 HasStaticData = (StaticSaveData != nullptr) ? 1 : 0;
-	Ar << HasStaticData;
-	if(StaticSaveData)
+	//!#7 String Table, !#8 Actor Directory, !#9 Property Layouts
 	{
-		SaveStaticData(Ar, StaticSaveData);
+		FMemoryWriter StringsWriter(Sections.Strings, true);
+		StringsWriter << Strings;
+		
+		FMemoryWriter DirectoryWriter(Sections.Directory, true);
+		DirectoryWriter << Directory;
+		
+		FMemoryWriter LayoutsWriter(Sections.Layouts, true);
+		LayoutsWriter << Layouts;
 	}
-	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-	
 	
-	//~~~~~~~~~~~~~~~~~~~
-	//! FINAL DO THIS LAST
-	//~~~~~~~~~~~~~~~~~~~
+	//IO Success?
+	if(StreamFile.IsValid())
+	{
+		StreamFile->EndSection();
+		StreamFile->WriteSection(RamaSaveSectionFile::Strings, Sections.Strings, Codec);
+		StreamFile->WriteSection(RamaSaveSectionFile::Directory, Sections.Directory, Codec);
+		StreamFile->WriteSection(RamaSaveSectionFile::Layouts, Sections.Layouts, Codec);
+		return StreamFile->Close() && !MemoryWriter.IsError();
+	}
+	return URamaSaveUtility::WriteSectionedFile(FileName,Sections,ToBinary,Codec);
+}
+
+bool ARamaSaveEngine::RamaSave_SaveInParallel(UWorld* World, const FString& FileName, FRamaSaveFileSections& Sections, TArray<uint8>& ToBinary, ERamaSaveCodec Codec, bool bStreaming, int32 TotalComponents, bool& AllComponentsSaved)
+{
+	//Layouts are all added before the workers start so they only look them up
+	FRamaSaveStringTable Strings;
+	FRamaSaveLayoutTable Layouts;
 	
-	//!#4 Component Total 
-	int32 TotalComponents = RamaSaveComponents.Num() - CompCountNotBeingSaved;
-	Ar << TotalComponents;
- 
-	//When not visible does not show at all
-	/*
-	const TArray<class ULevel*>& AllLevels = World->GetLevels();
-	for(const ULevel* EachLevel : AllLevels)
-	{ 
-		if(!EachLevel) continue;
-		if(EachLevel->GetOuter()) RS_LOG2(RamaSave,"Package is", EachLevel->GetOuter()->GetName() );
-		RS_LOGF(RamaSave,"Actor count for level is", EachLevel->Actors.Num());
+	//~~~ Game Thread ~~~
+	//	Snapshots of the live values, nothing changes them while saving
+	struct FRecord
+	{
+		FRamaSaveActorSnapshot Snapshot;
+		int64 Offset = 0;							//In the buffer of its chunk
+		int32 StringsEnd = 0;						//Entries of the chunk's table once the record is written
+		bool bWritten = true;
+	};
+	TIndirectArray<FRecord> Records;
+	for(URamaSaveComponent* EachSaveComp : RamaSaveComponents)
+	{
+		if(!EachSaveComp->RamaSave_ShouldSaveActor)
+		{
+			//Actor is not being saved right now per user request.
+			continue;
+		}
 		
+		FRecord* Record = new FRecord();
+		if(!EachSaveComp->TakeSnapshot(World, Record->Snapshot))
+		{
+			AllComponentsSaved = false;
+			delete Record;
+			continue;
+		}
+		Records.Add(Record);
+		Record->Snapshot.AddLayouts(Layouts, Strings);
 	}
-	*/
 	
-	//!#5 Serialize All Comps!
-	for(URamaSaveComponent* EachSaveComp : RamaSaveComponents)
-	{  
-		//FString LevelPackageName = EachSaveComp->GetActorStreamingLevelPackageName();
-		//RS_LOG2(RamaSave,"Saving Actor in package", LevelPackageName);
-		 
-		//! CAN NOW FILTER BASED ON PACKAGE NAME IF USER ONLY WANT SAVE PARTICULAR
-		 
-		/*
-		//Default
-		FString LevelPackageName = "PersistentLevel"; 
+	//~~~ Worker Threads ~~~
+	//	Contiguous chunks of records, each into its own buffer with a string table of its own, every record encoded once.
+	//	Streaming Save Load only encodes one wave of chunks at a time, each chunk about a streaming window,
+	//	and writes it out before the next, so memory stays a small multiple of the window instead of the whole world
+	struct FChunk
+	{
+		int32 First = 0;
+		int32 Last = 0;
+		TArray<uint8> Data;
+		FRamaSaveStringTable Strings;
+		TArray<int64> StringFixups;
+		
+		//Game thread, chunk table index to file table index, filled record by record
+		TArray<uint32> Remap;
+		int32 FixupsDone = 0;
+	};
+	auto EncodeChunk = [&](FChunk& Chunk)
+	{
+		FMemoryWriter Writer(Chunk.Data, false);
+		FRamaSaveArchive Ar(Writer, false, &Chunk.Strings);
+		Ar.Layouts = &Layouts;
+		Ar.StringFixups = &Chunk.StringFixups;
 		
-		if(!EachSaveComp->GetOwner()->IsInPersistentLevel())
+		for(int32 r = Chunk.First; r < Chunk.Last; r++)
+		{
+			FRecord& Record = Records[r];
+			Record.Offset = Ar.Tell();
+			Record.bWritten = Record.Snapshot.Write(Ar);
+			Record.StringsEnd = Chunk.Strings.Strings.Num();
+		}
+	};
+	
+	const int32 NumThreads = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	const int32 EvenRecords = FMath::Max(1, FMath::DivideAndRoundUp(Records.Num(), NumThreads * 4));
+	int32 RecordsPerChunk = EvenRecords;
+	int32 ChunksPerWave = MAX_int32;
+	const int64 WindowBytes = (int64)URamaSaveSystemSettings::Get()->StreamingWindowSizeMB * 1024 * 1024;
+	int64 EncodedBytes = 0;
+	int64 EncodedRecords = 0;
+	if(bStreaming)
+	{
+		//Record sizes are not known yet, the first wave is kept small and the rest sized from it
+		RecordsPerChunk = FMath::Min(RecordsPerChunk, 16);
+		ChunksPerWave = NumThreads * 2;
+	}
+	
+	TArray<FChunk> Wave;
+	int32 WaveEnd = 0;
+	int32 ChunkIndex = 0;
+	
+	//~~~ Game Thread ~~~
+	//	Records written in order, each one's strings added to the file's table as it is written, the same order the serial save uses
+	return WriteActorsFile(FileName, Sections, ToBinary, Codec, bStreaming, Strings, Layouts, TotalComponents, Records.Num(), [&](FRamaSaveArchive& Ar, int32 Index)
+	{
+		//First record of a wave, encode the whole wave
+		if(Index == WaveEnd)
 		{
-			LevelPackageName = "Huge very big error, Outer for non persistent actor was not found!!!!";
+			Wave.Reset();
+			while(WaveEnd < Records.Num() && Wave.Num() < ChunksPerWave)
+			{
+				FChunk& Chunk = Wave[Wave.AddDefaulted()];
+				Chunk.First = WaveEnd;
+				Chunk.Last = FMath::Min(Records.Num(), WaveEnd + RecordsPerChunk);
+				WaveEnd = Chunk.Last;
+			}
+			ChunkIndex = 0;
 			
-			ULevel* LevelForActor = EachSaveComp->GetOwner()->GetLevel();
-			 
-			//Rama Victory!!!
-			UObject* LevelOuter = LevelForActor->GetOuter();
-			if(!LevelOuter) continue;
+			ParallelFor(Wave.Num(), [&](int32 WaveIndex)
+			{
+				EncodeChunk(Wave[WaveIndex]);
+			});
 			
-			//! LESSON, the only retention /acknowledgement of level streaming is via the outer name, the level name is always "Persistent"
-			//! even when the actor says it is not part of persistent level
-			LevelPackageName = LevelOuter->GetName();
+			if(bStreaming)
+			{
+				for(const FChunk& Chunk : Wave)
+				{
+					EncodedBytes += Chunk.Data.Num();
+					EncodedRecords += Chunk.Last - Chunk.First;
+				}
+				RecordsPerChunk = (int32)FMath::Clamp<int64>(WindowBytes * EncodedRecords / FMath::Max<int64>(1, EncodedBytes), 1, EvenRecords);
+			}
 		}
-		*/
-		 
-		if(!EachSaveComp->RamaSave_SaveToFile(World,Ar))
+		if(Index == Wave[ChunkIndex].Last)
 		{
-			AllComponentsSaved = false;
+			ChunkIndex++;
 		}
-	}
-	
-	//VSCREENMSGF("TOTAL COMPS SAVED", TotalComponents);
-	 
-	//IO Success?
-	FileIOSuccess = URamaSaveUtility::CompressAndWriteToFile(ToBinary,FileName);
+		FChunk& Chunk = Wave[ChunkIndex];
+		FRecord& Record = Records[Index];
+		
+		//Strings this record used first, the file's table gets them in that order
+		for(int32 v = Chunk.Remap.Num(); v < Record.StringsEnd; v++)
+		{
+			Chunk.Remap.Add(Strings.Add(Chunk.Strings.Strings[v]));
+		}
+		
+		//Its bytes with the file's string indices
+		const int64 RecordEnd = Index + 1 < Chunk.Last ? Records[Index + 1].Offset : Chunk.Data.Num();
+		for( ; Chunk.FixupsDone < Chunk.StringFixups.Num() && Chunk.StringFixups[Chunk.FixupsDone] < RecordEnd; Chunk.FixupsDone++)
+		{
+			FRamaSaveArchive::RemapStringIndex(Chunk.Data.GetData() + Chunk.StringFixups[Chunk.FixupsDone], Chunk.Remap);
+		}
+		FRamaSaveActorSnapshot& Snapshot = Record.Snapshot;
+		for(uint32& Each : Snapshot.ObjectIndices)
+		{
+			Each = Chunk.Remap[Each];
+		}
+		
+		//The directory is added here so it is the same every time
+		Ar.Directory->Add(*Ar.Strings, Ar.Tell(), Snapshot.ActorClass, Snapshot.LevelPackageName, Snapshot.PersistentActorUniqueID, Snapshot.SaveTags, Snapshot.ObjectIndices);
+		Ar.Serialize(Chunk.Data.GetData() + Record.Offset, RecordEnd - Record.Offset);
+		
+		//Done with it, frees memory as the file is written
+		if(Index + 1 == Chunk.Last)
+		{
+			Chunk.Data.Empty();
+			Chunk.Strings.Reset();
+			Chunk.StringFixups.Empty();
+			Chunk.Remap.Empty();
+		}
+		return Record.bWritten;
+	}, AllComponentsSaved);
 }
 
-void ARamaSaveEngine::RamaSave_SaveToFile_ASYNC(FString FileName, bool& FileIOSuccess, bool& AllComponentsSaved, FString SaveOnlyStreamingLevel, URamaSaveObject* StaticSaveData)
+void ARamaSaveEngine::RamaSave_SaveToFile_ASYNC(FString FileName, bool& FileIOSuccess, bool& AllComponentsSaved, FString SaveOnlyStreamingLevel, URamaSaveObject* StaticSaveData, ERamaSaveCodec Codec)
 {
 	UWorld* World = GetWorld();
 	if (!World) return;
@@ -417,7 +831,14 @@ void ARamaSaveEngine::RamaSave_SaveToFile_ASYNC(FString FileName, bool& FileIOSu
 	check(Settings);
 	
 	RamaSaveAsync_FileName = FileName;
+	RamaSaveAsync_Codec = URamaSaveUtility::ResolveCodec(Codec);
 	RamaSaveAsync_ChunkGoal = Settings->AsyncSaveActorChunkSize;
+	RamaSaveAsync_BudgetMs = Settings->AsyncSaveFrameBudgetMs;
+	RamaSaveAsync_ActorCostMs = 0;
+	RamaSaveAsync_BudgetFrame = GFrameCounter - 1;
+	RamaSaveAsync_Frames = 0;
+	RamaSaveAsync_ActorsSaved = 0;
+	RamaSaveAsync_SpentMs = 0;
 	RamaSaveAsync_SaveChecks = Settings->Saving_PerformObjectValidityChecks;
 		
 	//~~~~~~~~~~~~~~~~~~~~~~~
@@ -439,63 +860,23 @@ void ARamaSaveEngine::RamaSave_SaveToFile_ASYNC(FString FileName, bool& FileIOSu
 	
 	//Have to create Archive at this level, and save the total number of components
 	//To then be loaded statically
-	RamaSaveAsync_ToBinary.Empty();
+	CollectFinishedSaveBuffers();
+	SaveBufferPool.Release(MoveTemp(RamaSaveAsync_ToBinary));
+	RamaSaveAsync_ToBinary = SaveBufferPool.Acquire();
 	
 	//~~~~~~~~~~~~~~~~~~
 	//  Clear Any Prev
 	ClearAsyncArchive();
 	//~~~~~~~~~~~~~~~~~~
 	
-	AsyncMemoryWriter = new FMemoryWriter(RamaSaveAsync_ToBinary, false);
+	//!#1 - #3 Header, Level Streaming, Static Data
+	SaveFileSections(World, StaticSaveData, RamaSaveAsync_Sections);
 	
-	//~~~ Versioning ~~~
-	 
-	//! #1
+	//~~~~~~~~~~~~~~~~~
+	// 		ASYNC
+	//~~~~~~~~~~~~~~~~~
 	
-	FMemoryWriter& Ar = *AsyncMemoryWriter;
-	
-	// Write version for this file format
-	int32 SavegameFileVersion = JOY_SAVE_VERSION;
-	Ar << SavegameFileVersion;		//<~~~ Rama Custom Serialization Version
-	
-	//! #2
-	 
-	// Write out engine and UE4 version information
-	int32 PackageFileUE4Version = GPackageFileUE4Version;
-	Ar << PackageFileUE4Version;
-	FEngineVersion SavedEngineVersion = FEngineVersion::Current();
-	Ar << SavedEngineVersion;
-	
-	//~~~ End Versioning ~~~
-	
-	//!#3 Level Streaming
-	TArray<FString> Streaming;
-	const TArray<ULevelStreaming*>& Levels = World->GetStreamingLevels();
-	for(ULevelStreaming* EachLevel : Levels)
-	{
-		if(!EachLevel) continue;
-		
-		FString NoPIELevelName = URamaSaveLibrary::RemoveLevelPIEPrefix(EachLevel->GetWorldAssetPackageName());
-		 
-		Streaming.Add(NoPIELevelName + FString("=") + BOOLSTR(EachLevel->IsLevelVisible()));
-	}
-	Ar << Streaming;
-	
-	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-	//!#4 STATIC DATA
-	uint8 HasStaticData = (StaticSaveData != nullptr) ? 1 : 0;
-	Ar << HasStaticData;
-	if(StaticSaveData)
-	{
-		SaveStaticData(Ar, StaticSaveData);
-	}
-	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-	
-	//~~~~~~~~~~~~~~~~~
-	// 		ASYNC
-	//~~~~~~~~~~~~~~~~~
-	
-	RamaSaveComponents.Empty();
+	RamaSaveComponents.Empty();
 	
 	//! FILTER OUT ACTORS by STREAMING LEVEL HERE!
 	URamaSaveLibrary::GetAllRamaSaveComponents(World,RamaSaveComponents,SaveOnlyStreamingLevel);
@@ -515,17 +896,31 @@ void ARamaSaveEngine::RamaSave_SaveToFile_ASYNC(FString FileName, bool& FileIOSu
 	
 	//!#5 Component Total 
 	RamaSaveAsync_TotalComponents = RamaSaveComponents.Num() - CompCountNotBeingSaved;
-	Ar << RamaSaveAsync_TotalComponents;
 	
+	//Save On Worker Thread, each tick only takes snapshots, the task writes everything once they are all taken
+	if(Settings->SaveOnWorkerThread)
+	{
+		RamaSaveAsync_Snapshots = MakeShareable(new FRamaSaveSnapshotBatch());
+		RamaSaveAsync_Snapshots->TotalComponents = RamaSaveAsync_TotalComponents;
+	}
+	else
+	{
+		AsyncMemoryWriter = new FMemoryWriter(RamaSaveAsync_ToBinary, false);
+		*AsyncMemoryWriter << RamaSaveAsync_TotalComponents;
+		
+		//Obj and Name as String
+		RamaSaveAsync_Strings.Reset();
+		RamaSaveAsync_Directory.Reset();
+		RamaSaveAsync_Layouts.Reset();
+		AsyncArchive = new FRamaSaveArchive(*AsyncMemoryWriter, false, &RamaSaveAsync_Strings);
+		AsyncArchive->Directory = &RamaSaveAsync_Directory;
+		AsyncArchive->Layouts = &RamaSaveAsync_Layouts;
+	}
 	
 	//~~~
 	
 	Async_SaveStarted(RamaSaveAsync_FileName);
 	
-		  
-	//Obj and Name as String
-	AsyncArchive = new FObjectAndNameAsStringProxyArchive(*AsyncMemoryWriter, false);
-	
 	//! START ASYNC
 	RamaSaveAsync_Index = 0;
 	SETTIMERH(TH_RamaSaveAsync,ARamaSaveEngine::RamaSaveAsync,Settings->AsyncSaveTickInterval,true);
@@ -565,14 +960,33 @@ void ARamaSaveEngine::RamaSaveAsync()
 	{
 		Async_ProgressUpdate(1);
 		CLEARTIMER(TH_RamaSaveAsync);
+		RamaSaveAsync_LogThroughput();
 		RamaSaveAsync_Finish();
 		return;
 	}
 	
+	//The budget is per frame, the timer can fire more than once in a frame
+	const bool bBudget = RamaSaveAsync_BudgetMs > 0;
+	if(bBudget && RamaSaveAsync_BudgetFrame != GFrameCounter)
+	{
+		RamaSaveAsync_BudgetFrame = GFrameCounter;
+		RamaSaveAsync_FrameSpentMs = 0;
+		RamaSaveAsync_FrameActors = 0;
+		RamaSaveAsync_Frames++;
+	}
+	
 	//Gooo!
 	for(; RamaSaveComponents.IsValidIndex(RamaSaveAsync_Index); RamaSaveAsync_Index++)
 	{
-		if(ChunkCount >= RamaSaveAsync_ChunkGoal)
+		if(bBudget)
+		{
+			//Stop before the next actor would likely go over, at least one a frame so the save always finishes
+			if(RamaSaveAsync_FrameActors > 0 && RamaSaveAsync_FrameSpentMs + RamaSaveAsync_ActorCostMs > RamaSaveAsync_BudgetMs)
+			{
+				return;
+			}
+		}
+		else if(ChunkCount >= RamaSaveAsync_ChunkGoal)
 		{
 			//Wait for next tick interval
 			return;
@@ -587,6 +1001,8 @@ void ARamaSaveEngine::RamaSaveAsync()
 		AActor* ActorOwner = EachSaveComp->GetOwner();
 		if(!ActorOwner) continue;
 		
+		const double ActorStartTime = FPlatformTime::Seconds();
+		
 		//Verify all properties can be saved!
 		if(RamaSaveAsync_SaveChecks) //Might want to skip for faster saving
 		{
@@ -637,9 +1053,34 @@ void ARamaSaveEngine::RamaSaveAsync()
 		//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 		//  RAMA SAVE COMPONENT ACTUAL SERIALIZATION IS HERE
 		//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-		bool Success = EachSaveComp->RamaSave_SaveToFile(World,*AsyncArchive);
+		bool Success = RamaSaveAsync_Snapshots.IsValid() ? RamaSaveAsync_Snapshots->Add(World, EachSaveComp) : EachSaveComp->RamaSave_SaveToFile(World,*AsyncArchive);
 		//if(!Success) report this
 		//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+		
+		//Includes the pre save events, they are part of what this actor costs the frame
+		const float ActorMs = (FPlatformTime::Seconds() - ActorStartTime) * 1000.0;
+		RamaSaveAsync_ActorCostMs = RamaSaveAsync_ActorsSaved == 0 ? ActorMs : FMath::Lerp(RamaSaveAsync_ActorCostMs, ActorMs, 0.2f);
+		RamaSaveAsync_FrameSpentMs += ActorMs;
+		RamaSaveAsync_FrameActors++;
+		RamaSaveAsync_ActorsSaved++;
+		RamaSaveAsync_SpentMs += ActorMs;
+	}
+}
+
+void ARamaSaveEngine::RamaSaveAsync_LogThroughput()
+{
+	if(RamaSaveAsync_ActorsSaved == 0) return;
+	
+	const double MsPerActor = RamaSaveAsync_SpentMs / RamaSaveAsync_ActorsSaved;
+	if(RamaSaveAsync_BudgetMs > 0 && RamaSaveAsync_Frames > 0)
+	{
+		UE_LOG(RamaSave, Log, TEXT("Rama Save ~ Async save of %s ~ %d actors in %d frames, %.1f actors per frame, %.3f ms per actor, %.2f ms per frame of a %.2f ms budget"), 
+			*RamaSaveAsync_FileName, RamaSaveAsync_ActorsSaved, RamaSaveAsync_Frames, float(RamaSaveAsync_ActorsSaved) / RamaSaveAsync_Frames, MsPerActor, RamaSaveAsync_SpentMs / RamaSaveAsync_Frames, RamaSaveAsync_BudgetMs
+		);
+	}
+	else
+	{
+		UE_LOG(RamaSave, Log, TEXT("Rama Save ~ Async save of %s ~ %d actors, %.3f ms per actor"), *RamaSaveAsync_FileName, RamaSaveAsync_ActorsSaved, MsPerActor);
 	}
 }
 	
@@ -648,12 +1089,37 @@ void ARamaSaveEngine::RamaSaveAsync_Finish()
 	//URamaSaveUtility::CompressAndWriteToFile(RamaSaveAsync_ToBinary,RamaSaveAsync_FileName);
 	 
 	//! Yes much faster, no delay at all
-	//FFileHelper::SaveArrayToFile(RamaSaveAsync_ToBinary, *RamaSaveAsync_FileName);
+	//	-> now ERamaSaveCodec::None, the codec is in the file header so loading handles both
+	
+	//Archive is done writing, the task owns the buffer from here on
+	FRamaSaveSnapshotBatchPtr Snapshots = MoveTemp(RamaSaveAsync_Snapshots);
+	ClearAsyncArchive();
 	
-	//VSCREENMSG("Faster with no compression?");
-	//Remember when I offer uncompressed I have to remember to also LOAD optionally compressed or uncompressed
+	//Save On Worker Thread, the task writes the records and the tables too
+	if(Snapshots.IsValid())
+	{
+		StartEncodeTask(Snapshots, MoveTemp(RamaSaveAsync_Sections), MoveTemp(RamaSaveAsync_ToBinary), RamaSaveAsync_FileName, RamaSaveAsync_Codec);
+		return;
+	}
+	
+	//!#7 String Table, !#8 Actor Directory, !#9 Property Layouts
+	{
+		FMemoryWriter StringsWriter(RamaSaveAsync_Sections.Strings, true);
+		StringsWriter << RamaSaveAsync_Strings;
+		RamaSaveAsync_Strings.Reset();
+		
+		FMemoryWriter DirectoryWriter(RamaSaveAsync_Sections.Directory, true);
+		DirectoryWriter << RamaSaveAsync_Directory;
+		RamaSaveAsync_Directory.Reset();
+		
+		FMemoryWriter LayoutsWriter(RamaSaveAsync_Sections.Layouts, true);
+		LayoutsWriter << RamaSaveAsync_Layouts;
+		RamaSaveAsync_Layouts.Reset();
+	}
 	
-	RamaSaveCompressedTask::Gooooo(RamaSaveAsync_ToBinary,RamaSaveAsync_FileName);
+	FRamaSaveWriteResultRef Result = MakeShared<FRamaSaveWriteResult, ESPMode::ThreadSafe>();
+	PendingWriteResult = Result;
+	RamaSaveCompressedTask::Gooooo(MoveTemp(RamaSaveAsync_Sections),MoveTemp(RamaSaveAsync_ToBinary),RamaSaveAsync_FileName,RamaSaveAsync_Codec,Result);
 	SETTIMERH(TH_CheckCompressToFileFinished, ARamaSaveEngine::CheckCompressToFileFinished,0.01,true);
 	
 }
@@ -664,8 +1130,37 @@ void ARamaSaveEngine::CheckCompressToFileFinished()
 	{
 		CLEARTIMER(TH_CheckCompressToFileFinished);
 		
+		//Buffer back into the pool for the next save
+		CollectFinishedSaveBuffers();
+		
+		//The task is done with it
+		FRamaSaveWriteResult Result;
+		if(PendingWriteResult.IsValid())
+		{
+			Result = *PendingWriteResult;
+			PendingWriteResult.Reset();
+		}
+		
+		if(Result.Size >= 0)
+		{
+			SaveBufferPool.LastSaveSize = Result.Size;
+		}
+		
+		if(!Result.bAllRecordsWritten)
+		{
+			UE_LOG(RamaSave, Warning, TEXT("Rama Save System ~ Not every actor was fully saved to %s, see the warnings above"), *RamaSaveAsync_FileName);
+		}
+		
 		//BP
-		Async_SaveFinished(RamaSaveAsync_FileName);
+		if(Result.bSucceeded)
+		{
+			Async_SaveFinished(RamaSaveAsync_FileName);
+		}
+		else
+		{
+			UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ File IO Error: Could not write save file! %s"), *RamaSaveAsync_FileName);
+			Async_SaveFailed(RamaSaveAsync_FileName);
+		}
 		
 		//~~~~~~~~~~~~~~~~~~~
 		// Free the Data now  <3 Rama
@@ -688,6 +1183,9 @@ void ARamaSaveEngine::ClearAsyncArchive()
 		delete AsyncMemoryWriter;
 		AsyncMemoryWriter = nullptr;
 	}
+	
+	//Snapshots not handed to a task yet
+	RamaSaveAsync_Snapshots.Reset();
 }
 
 //~~~~~~~~~~~~~~~~~~~
@@ -705,6 +1203,19 @@ void ARamaSaveEngine::Phase1(const FRamaSaveEngineParams& Params, bool HandleStr
 	
 	LoadParams = Params;
 	
+	//Any previous load still waiting?
+	CLEARTIMER(TH_WaitForDecode);
+	CLEARTIMER(TH_AsyncStreamingLoad);
+	if(PreloadHandle.IsValid())
+	{
+		PreloadHandle->CancelHandle();
+		PreloadHandle.Reset();
+	}
+	
+	//Decompression and parsing start right away on a worker thread,
+	//	overlapping with the level streaming below
+	StartLoadDecode();
+	
 	//User doesnt want async level streaming handling?
 	if(!HandleStreamingLevelsLoadingAndUnloading)
 	{
@@ -719,13 +1230,30 @@ void ARamaSaveEngine::Phase1(const FRamaSaveEngineParams& Params, bool HandleStr
 		return;
 	}
 		
+	Phase1_StreamingLevels();
+}
+
+void ARamaSaveEngine::Phase1_StreamingLevels()
+{
+	if(!GetWorld()) return;
+	if(!LoadDecodedFile.IsValid()) return;
+	
+	const FRamaSaveEngineParams& Params = LoadParams;
+	
+	//Streaming level states are known as soon as the worker has read the file header
+	if(!LoadDecodedFile->bHeaderReady)
+	{
+		SETTIMERH(TH_WaitForDecode, ARamaSaveEngine::Phase1_StreamingLevels, 0.01, false);
+		return;
+	}
+	
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	//Async load and unload of streaming levels
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-	TArray<FString> StreamingLevelsStates;
-	bool FileIOSuccess = false;
-	int32 TotalSublevels = URamaSaveLibrary::RamaSave_LoadStreamingStateFromFile(this, FileIOSuccess, Params.FileName, StreamingLevelsStates);
+	const TArray<FString>& StreamingLevelNames = LoadDecodedFile->StreamingLevelNames;
+	const TBitArray<>& StreamingLevelVisible = LoadDecodedFile->StreamingLevelVisible;
+	int32 TotalSublevels = StreamingLevelNames.Num();
 	
 	//No streaming data
 	if(TotalSublevels < 1)
@@ -735,7 +1263,7 @@ void ARamaSaveEngine::Phase1(const FRamaSaveEngineParams& Params, bool HandleStr
 	}
 	
 	//Only Persistent?
-	if(TotalSublevels == 1 && StreamingLevelsStates[0] == "PersistentLevel")
+	if(TotalSublevels == 1 && StreamingLevelNames[0] == "PersistentLevel")
 	{
 		//Only persistent was found!
 		Phase2();
@@ -753,13 +1281,10 @@ void ARamaSaveEngine::Phase1(const FRamaSaveEngineParams& Params, bool HandleStr
 		FString NoPIELevelName = URamaSaveLibrary::RemoveLevelPIEPrefix(EachLevel->GetWorldAssetPackageName());
 		
 		//Iterate Levels!
-		for(FString& EachSublevel : StreamingLevelsStates)
+		for(int32 SublevelIndex = 0; SublevelIndex < TotalSublevels; SublevelIndex++)
 		{
-			FString LevelName,State;
-			EachSublevel.Split(TEXT("="),&LevelName,&State);
-			 
 			//Match?
-			if(NoPIELevelName != LevelName) continue;
+			if(NoPIELevelName != StreamingLevelNames[SublevelIndex]) continue;
 			//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 			 
 			//Only Single?
@@ -773,7 +1298,7 @@ void ARamaSaveEngine::Phase1(const FRamaSaveEngineParams& Params, bool HandleStr
 			//RS_LOG2(RamaSave,LevelName, State);
 			  
 			//Make Visible
-			if(State.Contains("True"))
+			if(StreamingLevelVisible[SublevelIndex])
 			{
 				//Only do the async process if needed!
 				if(!EachLevel->ShouldBeVisible() || !EachLevel->ShouldBeLoaded() )
@@ -860,32 +1385,289 @@ void ARamaSaveEngine::AsyncStreamingLoad()
 	}
 }
 
+void ARamaSaveEngine::StartLoadDecode()
+{
+	//A save still being written on a worker thread could be the file about to be read
+	RamaSaveCompressedTask::WaitForTasks();
+	
+	//Fresh handle per load, a worker of a previous load keeps its own alive until done
+	LoadDecodedFile = MakeShareable(new FRamaSaveDecodedFile());
+	LoadDecodedFile->FileName = LoadParams.FileName;
+	LoadDecodedFile->bStreaming = URamaSaveSystemSettings::Get()->StreamingSaveLoad;
+	
+	TGraphTask<RamaSaveDecodeTask::FRamaLoadTask>::CreateTask(NULL, ENamedThreads::GameThread).ConstructAndDispatchWhenReady(LoadDecodedFile, LoadParams);
+}
+
+//Worker Thread!
+//	Only plain data here, no UObjects
+bool ARamaSaveEngine::ParseDecodedFile(FArchive& Reader, FRamaSaveDecodedFile& File, const FRamaSaveEngineParams& Params)
+{
+	//~~~ Versioning ~~~
+	
+	//! #1
+	// Read version for this file format
+	Reader << File.SaveVersion;
+	
+	//! #2
+	// Read engine and UE4 version information
+	Reader << File.SavedUE4Version;
+	Reader << File.SavedEngineVersion;
+	
+	//Set The Versions for the Reader!
+	Reader.SetUE4Ver(File.SavedUE4Version);
+	Reader.SetEngineVer(File.SavedEngineVersion);
+	
+	//~~~ End Versioning ~~~
+	
+	//!#3 Level Streaming
+	if(File.SaveVersion >= JOY_SAVE_VERSION_STREAMINGLEVELS)
+	{
+		//"Name=True", parsed once here so Phase1 only deals with names and flags
+		TArray<FString> StreamingLevelsStates;
+		Reader << StreamingLevelsStates;
+		
+		for(const FString& EachSublevel : StreamingLevelsStates)
+		{
+			FString LevelName,State;
+			EachSublevel.Split(TEXT("="),&LevelName,&State);
+			
+			File.StreamingLevelNames.Add(LevelName);
+			File.StreamingLevelVisible.Add(State.Contains("True"));
+		}
+	}
+	
+	//Phase1 can start streaming levels now
+	File.bHeaderReady = true;
+	
+	//~~~~~~~~~~~~~~~~~ 
+	//!#4
+	if(File.SaveVersion >= JOY_SAVE_VERSION_SAVEOBJECT)
+	{ 
+		uint8 HasStaticData = 0;
+		Reader << HasStaticData;
+		if(HasStaticData)
+		{
+			SkipStaticData(Reader);
+		}
+	}
+	//~~~~~~~~~~~~~~~~~
+	
+	return ParseActorRecords(Reader, File, Params);
+}
+
+bool ARamaSaveEngine::ParseSectionedFile(FRamaSaveSectionReader& Sections, FRamaSaveDecodedFile& File, const FRamaSaveEngineParams& Params)
+{
+	TArray<uint8> SectionBytes;
+	
+	//!#1 #2 Versioning
+	if(!Sections.ReadSection(RamaSaveSectionFile::Header, SectionBytes))
+	{
+		return false;
+	}
+	{
+		FMemoryReader Reader(SectionBytes, true);
+		Reader << File.SaveVersion;
+		Reader << File.SavedUE4Version;
+		Reader << File.SavedEngineVersion;
+		
+		if(Reader.IsError() || File.SaveVersion > JOY_SAVE_VERSION)
+		{
+			UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ File is from a newer Rama Save System version! %s"), *File.FileName);
+			return false;
+		}
+	}
+	
+	//!#3 Level Streaming
+	if(!Sections.ReadSection(RamaSaveSectionFile::Streaming, SectionBytes))
+	{
+		return false;
+	}
+	{
+		FMemoryReader Reader(SectionBytes, true);
+		Reader << File.StreamingLevelNames;
+		Reader << File.StreamingLevelVisible;
+		
+		if(Reader.IsError() || File.StreamingLevelNames.Num() != File.StreamingLevelVisible.Num())
+		{
+			return false;
+		}
+	}
+	
+	//Phase1 can start streaming levels now
+	File.bHeaderReady = true;
+	
+	//Static data section is not needed to load actors
+	
+	//!#7 String Table, needed by the actor records
+	if(File.SaveVersion >= JOY_SAVE_VERSION_STRINGTABLE)
+	{
+		if(!Sections.ReadSection(RamaSaveSectionFile::Strings, SectionBytes))
+		{
+			return false;
+		}
+		FMemoryReader Reader(SectionBytes, true);
+		Reader << File.Strings;
+		if(Reader.IsError())
+		{
+			return false;
+		}
+		File.bHasStrings = true;
+	}
+	
+	//!#8 Actor Directory, lets filtered loads skip straight to matching records
+	if(File.SaveVersion >= JOY_SAVE_VERSION_DIRECTORY && File.bHasStrings)
+	{
+		if(!Sections.ReadSection(RamaSaveSectionFile::Directory, SectionBytes))
+		{
+			return false;
+		}
+		FMemoryReader Reader(SectionBytes, true);
+		File.Directory.bObjectReferences = File.SaveVersion >= JOY_SAVE_VERSION_OBJECTREFS;
+		Reader << File.Directory;
+		if(Reader.IsError())
+		{
+			return false;
+		}
+		File.bHasDirectory = true;
+	}
+	
+	//!#9 Property Layouts, needed by the property blocks
+	if(File.SaveVersion >= JOY_SAVE_VERSION_LAYOUTS && File.bHasStrings)
+	{
+		if(!Sections.ReadSection(RamaSaveSectionFile::Layouts, SectionBytes))
+		{
+			return false;
+		}
+		FMemoryReader Reader(SectionBytes, true);
+		Reader << File.Layouts;
+		if(Reader.IsError() || !File.Layouts.IsValid(File.Strings))
+		{
+			return false;
+		}
+		File.bHasLayouts = true;
+	}
+	
+	//!#5 Actors, mapped, streaming or decompressed into Data
+	File.FileReader.Reset(Sections.OpenSection(RamaSaveSectionFile::Actors, File.bStreaming, File.Data));
+	if(!File.FileReader.IsValid())
+	{
+		return false;
+	}
+	
+	File.FileReader->SetUE4Ver(File.SavedUE4Version);
+	File.FileReader->SetEngineVer(File.SavedEngineVersion);
+	
+	return ParseActorRecords(*File.FileReader, File, Params);
+}
+
+bool ARamaSaveEngine::ParseActorRecords(FArchive& Reader, FRamaSaveDecodedFile& File, const FRamaSaveEngineParams& Params)
+{
+	//!#5 Component Total
+	int32 TotalComponents = 0;
+	Reader << TotalComponents;
+	
+	//Class names and level names come from the string table
+	FRamaSaveArchive Ar(Reader, true, File.GetStrings());
+	Ar.bSizedRecords = File.SaveVersion >= JOY_SAVE_VERSION_SIZEDRECORDS;
+	
+	//Directory, only the headers of records that can pass the filters are read
+	if(File.bHasDirectory)
+	{
+		TArray<int32> Candidates;
+		File.Directory.FindCandidates(File.Strings, Params.LoadOnlyActorsWithSaveTags, Params.LoadOnlyStreamingLevel, Candidates);
+		
+		File.Records.Reserve(Candidates.Num());
+		for(int32 EntryIndex : Candidates)
+		{
+			Reader.Seek(File.Directory.Entries[EntryIndex].RecordBegin);
+			
+			FRamaSaveActorRecord Record;
+			URamaSaveComponent::ReadActorRecordHeader(Ar, File.SaveVersion, Record);
+			if(Reader.IsError() || Ar.IsError())
+			{
+				return false;
+			}
+			
+			//The tag mask already decided it, unless the record has tags beyond the mask that are only in the header
+			const bool bMaskConclusive = !(File.Directory.Entries[EntryIndex].TagMask & FRamaSaveActorDirectory::TagOverflow);
+			if(bMaskConclusive || URamaSaveComponent::ShouldLoadActorRecord(Record, Params.LoadOnlyActorsWithSaveTags, Params.LoadOnlyStreamingLevel))
+			{
+				Record.ObjectIndices = MoveTemp(File.Directory.Entries[EntryIndex].ObjectIndices);
+				File.Records.Add(MoveTemp(Record));
+			}
+		}
+		
+		//Directory is not needed past here
+		File.Directory.Reset();
+		return true;
+	}
+	
+	//!#6 Actor record headers, properties are applied later on the game thread
+	File.Records.Reserve(TotalComponents);
+	for(int32 v = 0; v < TotalComponents; v++)
+	{
+		FRamaSaveActorRecord Record;
+		URamaSaveComponent::ReadActorRecordHeader(Ar, File.SaveVersion, Record);
+		if(Reader.IsError() || Ar.IsError())
+		{
+			return false;
+		}
+		
+		//Skip! Essential to maintain integrity of load process!
+		Reader.Seek(Record.RecordEnd);
+		
+		if(URamaSaveComponent::ShouldLoadActorRecord(Record, Params.LoadOnlyActorsWithSaveTags, Params.LoadOnlyStreamingLevel))
+		{
+			File.Records.Add(MoveTemp(Record));
+		}
+	}
+	
+	return !Reader.IsError();
+}
+
 void ARamaSaveEngine::Phase2()
 {
-	//Victory Decompress File
-	TArray<uint8> Uncompressed_FromBinary;
-	if( !URamaSaveUtility::DecompressFromFile(LoadParams.FileName,Uncompressed_FromBinary))
+	//C++ users may come here directly
+	if(!LoadDecodedFile.IsValid())
 	{
-		//File could not be loaded!
+		StartLoadDecode();
+	}
+	
+	//Worker still busy? Check back soon, game thread stays responsive meanwhile
+	if(!LoadDecodedFile->bFinished)
+	{
+		SETTIMERH(TH_WaitForDecode, ARamaSaveEngine::Phase2, 0.01, false);
 		return;
 	}
-	//~~~~~~~~~~~~~~~~~~~
 	
+	//Stream in classes and assets first, comes back here once they are in memory
+	if(!LoadDecodedFile->bPreloaded && LoadDecodedFile->bValid)
+	{
+		LoadDecodedFile->bPreloaded = true;
+		if(Phase2_Preload(*LoadDecodedFile))
+		{
+			return;
+		}
+	}
 	
+	//Take ownership for this load, the decoded file is released when Phase2 returns
+	FRamaSaveDecodedFilePtr DecodedFile = LoadDecodedFile;
+	LoadDecodedFile.Reset();
 	
-	//~~~
+	if(!DecodedFile->bValid)
+	{
+		//File could not be loaded!
+		UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ File could not be decompressed or parsed! %s"), *LoadParams.FileName);
+		Async_LoadFailed(LoadParams.FileName);
+		return;
+	}
+	//~~~~~~~~~~~~~~~~~~~
 	
 	bool AllComponentsLoaded = true;
 	
-	FMemoryReader MemoryReader(Uncompressed_FromBinary, true);
-
-	 
 	//~~~ Versioning ~~~
 	
-	//! #1
-	// Read version for this file format
-	int32 SavegameFileVersion;
-	MemoryReader << SavegameFileVersion;
+	int32 SavegameFileVersion = DecodedFile->SaveVersion;
  
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	//For global access during load process
@@ -907,61 +1689,35 @@ void ARamaSaveEngine::Phase2()
 	{
 		URamaSaveLibrary::RamaSave_ClearLevel(GetWorld(),LoadParams.DontLoadPlayerPawns,LoadParams.LoadOnlyStreamingLevel); //Dont destroy existing player pawns because they are also not loaded.
 	}
- 	 
-	//! #2
-	// Read engine and UE4 version information
 	
-	int32 SavedUE4Version;
-	MemoryReader << SavedUE4Version;
-
-	FEngineVersion SavedEngineVersion;
-	MemoryReader << SavedEngineVersion;
-
+	FMemoryReader MemoryReader(DecodedFile->Data, true);
+	
+	//Memory mapped, or Streaming Save Load reading a window at a time
+	FArchive& FileReader = DecodedFile->FileReader.IsValid() ? *DecodedFile->FileReader : (FArchive&)MemoryReader;
+	
 	//Set The Versions for the Memory Reader!
-	MemoryReader.SetUE4Ver(SavedUE4Version);
-	MemoryReader.SetEngineVer(SavedEngineVersion);
+	FileReader.SetUE4Ver(DecodedFile->SavedUE4Version);
+	FileReader.SetEngineVer(DecodedFile->SavedEngineVersion);
 	
 	//~~~ End Versioning ~~~
 	
 	//Obj and Name as String
-	FObjectAndNameAsStringProxyArchive Ar(MemoryReader, true);
-	 
-	 
-	//!#3 Level Streaming, have to process
-	TArray<FString> Streaming;
-	if(SavegameFileVersion >= JOY_SAVE_VERSION_STREAMINGLEVELS)
-	{
-		//Load Streaming Levels!
-		Ar << Streaming;
-	}
-	
-	//~~~~~~~~~~~~~~~~~ 
-	//!#4
-	if(SavegameFileVersion >= JOY_SAVE_VERSION_SAVEOBJECT)
-	{ 
-		uint8 HasStaticData = 0;
-		Ar << HasStaticData;
-		if(HasStaticData)
-		{
-			SkipStaticData(Ar);
-		}
-	}
-	//~~~~~~~~~~~~~~~~~
+	FRamaSaveArchive Ar(FileReader, true, DecodedFile->GetStrings());
+	Ar.bSizedRecords = SavegameFileVersion >= JOY_SAVE_VERSION_SIZEDRECORDS;
+	Ar.bRawValues = SavegameFileVersion >= JOY_SAVE_VERSION_RAWVALUES;
+	Ar.bReferenceTable = SavegameFileVersion >= JOY_SAVE_VERSION_OBJECTTABLE;
+	Ar.Layouts = DecodedFile->GetLayouts();
 	
-	//!#5 Component Total
-	int32 TotalComponents = 0;
-	Ar << TotalComponents;
-	
-	
-	//VSCREENMSGF("Load process got here! Comps to load is", TotalComponents);
+	//VSCREENMSGF("Load process got here! Comps to load is", DecodedFile->Records.Num());
 	
 	//!#6 All Comps!
-	//For Loop to load each entry statically
+	//	Headers were parsed and filtered by the worker, only spawn and apply here
 	TArray<URamaSaveComponent*> LoadedComps;
-	for(int32 v = 0; v < TotalComponents; v++)
+	TMap<FString, UClass*> ActorClasses;
+	for(const FRamaSaveActorRecord& EachRecord : DecodedFile->Records)
 	{
 		LoadedComps.AddZeroed(1);
-		if(!URamaSaveComponent::RamaSave_LoadFromFile(GetWorld(), SavegameFileVersion, LoadParams.LoadOnlyActorsWithSaveTags, Ar, LoadedComps.Last(), LoadParams.DontLoadPlayerPawns,LoadParams.LoadOnlyStreamingLevel))
+		if(!URamaSaveComponent::RamaSave_LoadFromRecord(GetWorld(), EachRecord, Ar, LoadedComps.Last(), LoadParams.DontLoadPlayerPawns, &ActorClasses))
 		{
 			//At least one component was not loaded!
 			AllComponentsLoaded = false;
@@ -996,13 +1752,147 @@ void ARamaSaveEngine::Phase2()
 		 
 		EachSaveComp->FullyLoaded();
 	}
+	
+	//Spawned actors hold on to what they use now
+	PreloadHandle.Reset();
+}
+
+bool ARamaSaveEngine::ShouldPreload(const FString& Path)
+{
+	//Assets only, not native classes, transient objects or objects inside a level (Map.Map:PersistentLevel.Actor)
+	if(!Path.StartsWith(TEXT("/")) || Path.StartsWith(TEXT("/Script/")) || Path.StartsWith(TEXT("/Engine/Transient")))
+	{
+		return false;
+	}
+	if(Path.Contains(SUBOBJECT_DELIMITER) || !FPackageName::IsValidObjectPath(Path))
+	{
+		return false;
+	}
+	
+	//Already in memory
+	return FindObject<UObject>(nullptr, *Path) == nullptr;
+}
+
+bool ARamaSaveEngine::Phase2_Preload(const FRamaSaveDecodedFile& File)
+{
+	TSet<FString> Paths;
+	
+	//Classes of the actors that will be spawned
+	for(const FRamaSaveActorRecord& EachRecord : File.Records)
+	{
+		if(!EachRecord.PersistentActorUniqueID.IsValid())
+		{
+			Paths.Add(EachRecord.ActorClassFullPath);
+		}
+	}
+	
+	//Objects referenced by the values of the records being loaded, older files are looked up as each value is loaded
+	for(const FRamaSaveActorRecord& EachRecord : File.Records)
+	{
+		for(uint32 Index : EachRecord.ObjectIndices)
+		{
+			if(File.Strings.Strings.IsValidIndex(Index))
+			{
+				Paths.Add(File.Strings.Strings[Index]);
+			}
+		}
+	}
+	
+	TArray<FSoftObjectPath> ToLoad;
+	for(const FString& Each : Paths)
+	{
+		if(ShouldPreload(Each))
+		{
+			ToLoad.Add(FSoftObjectPath(Each));
+		}
+	}
+	
+	if(ToLoad.Num() < 1)
+	{
+		return false;
+	}
+	
+	UE_LOG(RamaSave, Log, TEXT("Rama Save System ~ Preloading %d classes and assets for %s"), ToLoad.Num(), *File.FileName);
+	
+	//May call Phase2 right away if everything is already loaded, File is not touched after this
+	TSharedPtr<FStreamableHandle> Handle = PreloadStreamable.RequestAsyncLoad(ToLoad, FStreamableDelegate::CreateUObject(this, &ARamaSaveEngine::Phase2));
+	if(!Handle.IsValid())
+	{
+		return false;
+	}
+	
+	//Only kept while loading, once complete Phase2 has run and released what it no longer needs
+	if(!Handle->HasLoadCompleted())
+	{
+		PreloadHandle = Handle;
+	}
+	return true;
 }
 
 
 
 //~~~
 
-void ARamaSaveEngine::SaveStaticData(FArchive& Ar, URamaSaveObject* StaticData)
+void ARamaSaveEngine::SaveFileSections(UWorld* World, URamaSaveObject* StaticSaveData, FRamaSaveFileSections& Sections)
+{
+	//~~~ Versioning ~~~
+	{
+		Sections.Header.Reset();
+		FMemoryWriter Ar(Sections.Header, true);
+		
+		//! #1
+		// Write version for this file format
+		int32 SavegameFileVersion = JOY_SAVE_VERSION;
+		Ar << SavegameFileVersion;		//<~~~ Rama Custom Serialization Version
+		
+		//! #2
+		// Write out engine and UE4 version information
+		int32 PackageFileUE4Version = GPackageFileUE4Version;
+		Ar << PackageFileUE4Version;
+		FEngineVersion SavedEngineVersion = FEngineVersion::Current();
+		Ar << SavedEngineVersion;
+	}
+	//~~~ End Versioning ~~~
+	
+	//!#3 Level Streaming
+	{
+		//Level names and one visible bit each, no per level strings to build and parse
+		TArray<FString> LevelNames;
+		TBitArray<> LevelVisible;
+		
+		const TArray<ULevelStreaming*>& Levels = World->GetStreamingLevels();
+		for(ULevelStreaming* EachLevel : Levels)
+		{
+			if(!EachLevel) continue;
+			
+			LevelNames.Add(URamaSaveLibrary::RemoveLevelPIEPrefix(EachLevel->GetWorldAssetPackageName()));
+			LevelVisible.Add(EachLevel->IsLevelVisible());
+		}
+		
+		Sections.Streaming.Reset();
+		FMemoryWriter Ar(Sections.Streaming, true);
+		Ar << LevelNames;
+		Ar << LevelVisible;
+	}
+	
+	//!#4 STATIC DATA
+	{
+		Sections.StaticData.Reset();
+		FMemoryWriter MemoryWriter(Sections.StaticData, true);
+		
+		//Obj and Name as String
+		FRamaSaveArchive Ar(MemoryWriter, false, nullptr);
+		
+		uint8 HasStaticData = (StaticSaveData != nullptr) ? 1 : 0;
+		Ar << HasStaticData;
+		if(StaticSaveData)
+		{
+			SaveStaticData(Ar, StaticSaveData);
+		}
+	}
+}
+
+void ARamaSaveEngine::SaveStaticData(FRamaSaveArchive& Ar, URamaSaveObject* StaticData)
 {
 	if(!StaticData->IsValidLowLevelFast() || StaticData->IsPendingKill())
 	{
@@ -1020,16 +1910,8 @@ void ARamaSaveEngine::SaveStaticData(FArchive& Ar, URamaSaveObject* StaticData)
 	FString ClassFullPath = FStringClassReference(StaticData->GetClass()).ToString();
 	Ar << ClassFullPath;
 	
-	//! #2
-	int64 StaticDataSkipPos = Ar.Tell();
-	Ar << StaticDataSkipPos;
-	
-	//! #3
-	//Serialize the total count, even if it is 0! 
-	int64 TotalProperties = 0;
-	int64 PropertiesBegin = Ar.Tell();		//cant assume starting at 0!
-	Ar << TotalProperties;
-	
+	//Gathered first so the total is known before writing
+	TArray<UProperty*, TInlineAllocator<16>> PropertiesToSave;
 	for (TFieldIterator<UProperty> It(StaticData->GetClass()); It; ++It)
 	{
 		UProperty* Property = *It;
@@ -1053,41 +1935,23 @@ void ARamaSaveEngine::SaveStaticData(FArchive& Ar, URamaSaveObject* StaticData)
 		{
 			UE_LOG(RamaSave, Log, TEXT("%s ~ Saving Static Data Property: %s"), *StaticData->GetClass()->GetName(), *PropertyNameString);
 		}
-		 
-		//We want each property as pure binary data 
-		//		so we can easily save it to disk and not worry about its exact type!
-		uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(StaticData); 
-		
-		int64 StartAfterStringPos = 0; //Ar POSITION TO STORE THE END POS AT
-		int64 EndPos = 0; 						//Postion after serializing property
 		
-		//Serialize Instance of Property!
-		Ar << PropertyNameString;
-		StartAfterStringPos = Ar.Tell();
-		Ar << EndPos;
-		 
-		Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(),InstanceValuePtr); 
-		
-		EndPos = Ar.Tell();
-		Ar.Seek(StartAfterStringPos);
-		Ar << EndPos;
-		Ar.Seek(EndPos);
-		
-		TotalProperties++;
+		PropertiesToSave.Add(Property);
 	} 
-	 
-	//Put the total at the beginning of archive so know how big of for loop to amke
-	int64 ArchiveEnd = Ar.Tell();
-	Ar.Seek(PropertiesBegin);
-	Ar << TotalProperties;
-	
-	Ar.Seek(StaticDataSkipPos);
-	Ar << ArchiveEnd;
 	
-	//Move back to end of archive 
-	//		so as to not ovewrite all data 
-	//			when next archive entries occur!!
-	Ar.Seek(ArchiveEnd); //<~~~ !
+	//! #2 Sized, so loading can skip it
+	Ar.SaveSized([&](FRamaSaveArchive& StaticAr)
+	{
+		//! #3
+		//Serialize the total count, even if it is 0! 
+		int64 TotalProperties = PropertiesToSave.Num();
+		StaticAr << TotalProperties;
+		
+		for(UProperty* Property : PropertiesToSave)
+		{
+			URamaSaveComponent::SaveProperty(StaticAr, Property, StaticData);
+		}
+	});
 }
 
 void ARamaSaveEngine::SkipStaticData(FArchive& Ar)
@@ -1114,14 +1978,41 @@ URamaSaveObject* ARamaSaveEngine::LoadStaticData(bool& FileIOSuccess,  FString F
 	
 	FileIOSuccess = false;
 	
-	//Victory Decompress File
 	TArray<uint8> Uncompressed_FromBinary;
-	if( !URamaSaveUtility::DecompressFromFile(FileName,Uncompressed_FromBinary))
+	TUniquePtr<FArchive> FileReader;
+	
+	//Sectioned file, only the header and static data sections are read
+	TUniquePtr<FRamaSaveSectionReader> Sectioned(FRamaSaveSectionReader::OpenFile(FileName));
+	if(Sectioned.IsValid())
 	{
-		//File could not be loaded!
-		return nullptr;
+		TArray<uint8> StaticDataBytes;
+		if(!Sectioned->ReadSection(RamaSaveSectionFile::Header, Uncompressed_FromBinary)
+			|| !Sectioned->ReadSection(RamaSaveSectionFile::StaticData, StaticDataBytes))
+		{
+			return nullptr;
+		}
+		
+		//Header then static data, read like an older file without its streaming list
+		Uncompressed_FromBinary.Append(StaticDataBytes);
+		FileReader.Reset(new FMemoryReader(Uncompressed_FromBinary, true));
+	}
+	
+	//Only the start of the file is needed, map it or decompress just the first block if possible
+	if(!FileReader.IsValid())
+	{
+		FileReader.Reset(URamaSaveUtility::OpenFileReader(FileName, true, 1));
+	}
+	if(!FileReader.IsValid())
+	{
+		//Victory Decompress File
+		if( !URamaSaveUtility::DecompressFromFile(FileName,Uncompressed_FromBinary))
+		{
+			//File could not be loaded!
+			return nullptr;
+		}
+		FileReader.Reset(new FMemoryReader(Uncompressed_FromBinary, true));
 	}
-	FMemoryReader MemoryReader(Uncompressed_FromBinary, true);
+	FArchive& MemoryReader = *FileReader;
 	
 	//~~~ Versioning ~~~
 	
@@ -1157,12 +2048,13 @@ URamaSaveObject* ARamaSaveEngine::LoadStaticData(bool& FileIOSuccess,  FString F
 	//~~~ End Versioning ~~~
 	
 	//Obj and Name as String
-	FObjectAndNameAsStringProxyArchive Ar(MemoryReader, true);
-	 
+	FRamaSaveArchive Ar(MemoryReader, true, nullptr);
+	Ar.bSizedRecords = SavegameFileVersion >= JOY_SAVE_VERSION_SIZEDRECORDS;
+	Ar.bRawValues = SavegameFileVersion >= JOY_SAVE_VERSION_RAWVALUES;
 	 
 	//!#3 Level Streaming, have to process
 	TArray<FString> Streaming;
-	if(SavegameFileVersion > 3)
+	if(!Sectioned.IsValid() && SavegameFileVersion > 3)
 	{
 		//Load Streaming Levels!
 		Ar << Streaming;
@@ -1187,7 +2079,14 @@ URamaSaveObject* ARamaSaveEngine::LoadStaticData(bool& FileIOSuccess,  FString F
 
 	//! #2
 	int64 StaticDataSkipPos;
-	Ar << StaticDataSkipPos;
+	if(Ar.bSizedRecords)
+	{
+		StaticDataSkipPos = Ar.LoadSizedEnd();
+	}
+	else
+	{
+		Ar << StaticDataSkipPos;
+	}
 	
 	if(ClassFullPath == "")
 	{
@@ -1230,22 +2129,20 @@ URamaSaveObject* ARamaSaveEngine::LoadStaticData(bool& FileIOSuccess,  FString F
 	for(int64 v = 0; v < TotalProperties; v++)
 	{
 		//Get info about each property before deciding whether to serialize
-		FString PropertyNameString;
-		int64 EndPosToSkip;
-		Ar << PropertyNameString;
-		Ar << EndPosToSkip; 
+		FName PropertyName;
+		const int64 EndPosToSkip = URamaSaveComponent::LoadPropertyHeader(Ar, PropertyName);
 			 
-		UProperty* Property = FindField<UProperty>( RSO->GetClass(), *PropertyNameString );
+		UProperty* Property = FindField<UProperty>( RSO->GetClass(), PropertyName );
 		if(Property) 
 		{ 
 			uint8* InstanceValuePtr = Property->ContainerPtrToValuePtr<uint8>(RSO); 
 			
 			//Serialize Instance!
-			Property->SerializeItem(FStructuredArchiveFromArchive(Ar).GetSlot(),InstanceValuePtr);
+			URamaSaveComponent::LoadPropertyValue(Ar, Property, InstanceValuePtr, EndPosToSkip);
 			
 			if(Settings->LogSavingAndLoadingOfEachStaticDataProperty)
 			{
-				UE_LOG(RamaSave, Log, TEXT("%s ~ Loading Static Data Property: %s"), *RSO->GetClass()->GetName(), *PropertyNameString);
+				UE_LOG(RamaSave, Log, TEXT("%s ~ Loading Static Data Property: %s"), *RSO->GetClass()->GetName(), *PropertyName.ToString());
 			}
 		}
 		else
@@ -1254,7 +2151,7 @@ URamaSaveObject* ARamaSaveEngine::LoadStaticData(bool& FileIOSuccess,  FString F
 			// MUST HAVE BEEN REMOVED
 			Ar.Seek(EndPosToSkip);
 			 
-			UE_LOG(RamaSave,Warning,TEXT("Property in save file but not found in class, re-save to get rid of this message %s %s"), *RSO->GetClass()->GetName(), *PropertyNameString);
+			UE_LOG(RamaSave,Warning,TEXT("Property in save file but not found in class, re-save to get rid of this message %s %s"), *RSO->GetClass()->GetName(), *PropertyName.ToString());
 		}
 	}
 	 
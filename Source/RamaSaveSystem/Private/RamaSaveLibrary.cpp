@@ -1,9 +1,14 @@
 // Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
 #include "RamaSaveSystemPrivatePCH.h"
 #include "RamaSaveLibrary.h"
+#include "RamaSaveSectionFile.h"
+#include "RamaSaveRegistry.h"
+#include "RamaSaveClassPlan.h"
  
 #include "RamaSaveSystemSettings.h"
 
+#include "ParallelFor.h"
+
  
 //////////////////////////////////////////////////////////////////////////
 // URamaSaveLibrary
@@ -117,82 +122,122 @@ bool URamaSaveLibrary::VerifyActorAndComponentProperties(URamaSaveComponent* Sav
 		return false;
 	}
 	
-	//Actor
-	for (TFieldIterator<UProperty> It(ActorOwner->GetClass()); It; ++It)
+	//Actor, only the object properties that are in RamaSave_OwningActorVarsToSave
+	if(UObjectProperty* ObjProp = FindUnloadableObjectProperty(ActorOwner, FRamaSaveClassPlan::Get(ActorOwner->GetClass()).GetObjectSelection(SaveComp->RamaSave_OwningActorVarsToSave)))
 	{
-		UProperty* Property = *It;
-		FString PropertyNameString = Property->GetFName().ToString();
+		ReportUnloadableObjectProperty(SaveComp, ObjProp, true);
+		return false;
+	}
+	
+	//Save Component
+	if(UObjectProperty* ObjProp = FindUnloadableObjectProperty(SaveComp, FRamaSaveClassPlan::Get(SaveComp->GetClass()).GetObjectProperties()))
+	{
+		ReportUnloadableObjectProperty(SaveComp, ObjProp, false);
+		return false;
+	}
+	 
+	return true;
+}
+
+URamaSaveComponent* URamaSaveLibrary::VerifyAllActorAndComponentProperties(const TArray<URamaSaveComponent*>& SaveComps)
+{
+	struct FCheck
+	{
+		AActor* ActorOwner = nullptr;
+		const TArray<UObjectProperty*>* OwnerProperties = nullptr;
+		const TArray<UObjectProperty*>* CompProperties = nullptr;
 		
-		//Is this property in the list of properties to save to disk?
-		if(!SaveComp->RamaSave_OwningActorVarsToSave.Contains(PropertyNameString))
-		{ 
-			//Skip
+		UObjectProperty* Failed = nullptr;
+		bool bOwningActor = false;
+	};
+	
+	//Class plans are game thread only, every lookup happens here first
+	TArray<FCheck> Checks;
+	Checks.SetNum(SaveComps.Num());
+	for(int32 v = 0; v < SaveComps.Num(); v++)
+	{
+		URamaSaveComponent* SaveComp = SaveComps[v];
+		AActor* ActorOwner = SaveComp ? SaveComp->GetOwner() : nullptr;
+		if(!ActorOwner)
+		{
 			continue;
 		}
-		 
-		//Check Object Properties
-		UObjectProperty* ObjProp = Cast<UObjectProperty>(Property);
-		if(ObjProp)
-		{    
-			UObject* Obj = ObjProp->GetObjectPropertyValue_InContainer(ActorOwner);
-			if(!Obj)
-			{
-				continue;
-			}
-
-			//Verfiy this is a load-able UObject Ptr !  <3 Rama
-			if(!URamaSaveUtility::VerifyObjectCanBeLoaded(Obj))
-			{ 	
-				VSCREENMSGSEC(12, "Save Process has been cancelled!");
-				VSCREENMSGSEC(12, "Please remove the invalid properties from the save name array, RamaSave_OwningActorVarsToSave"); 
-				
-				FString Msg = "The variable ~ " + PropertyNameString + " ~ found in " + ActorOwner->GetClass()->GetName();
-				Msg += " >> This type of UObject Ptr cannot be saved/loaded directly. Save individual variable values and recreate in Actor Fully Loaded Event <3 Rama";
-				VSCREENMSGSEC(12, Msg);
-				UE_LOG(RamaSave,Error,TEXT("%s"), *Msg);
-				 
-				VSCREENMSGSEC(12, "~~~ Rama Save System Message ~~~");
-				 
-				return false;
-			}  
-		} 
+		
+		FCheck& Check = Checks[v];
+		Check.ActorOwner = ActorOwner;
+		Check.OwnerProperties = &FRamaSaveClassPlan::Get(ActorOwner->GetClass()).GetObjectSelection(SaveComp->RamaSave_OwningActorVarsToSave);
+		Check.CompProperties = &FRamaSaveClassPlan::Get(SaveComp->GetClass()).GetObjectProperties();
 	}
 	
-	//Save Component
-	for (TFieldIterator<UProperty> It(SaveComp->GetClass()); It; ++It)
+	//~~~ Worker Threads ~~~
+	ParallelFor(Checks.Num(), [&](int32 Index)
 	{
-		UProperty* Property = *It;
-		FString PropertyNameString = Property->GetFName().ToString();
+		FCheck& Check = Checks[Index];
+		if(!Check.ActorOwner)
+		{
+			return;
+		}
 		
-		//Check Object Properties
-		UObjectProperty* ObjProp = Cast<UObjectProperty>(Property);
-		if(ObjProp)
-		{    
-			UObject* Obj = ObjProp->GetObjectPropertyValue_InContainer(SaveComp);
-			if(!Obj)
-			{
-				continue;
-			}
- 
-			//Verfiy this is a load-able UObject Ptr !  <3 Rama
-			if(!URamaSaveUtility::VerifyObjectCanBeLoaded(Obj))
-			{ 	
-				VSCREENMSGSEC(12, "Save Process has been cancelled!");
-				VSCREENMSGSEC(12, "Please remove the invalid properties from the Rama Save Component");
-				 
-				FString Msg = "The variable ~ " + PropertyNameString + " ~ found in " + SaveComp->GetClass()->GetName();
-				Msg += " >> This type of UObject Ptr cannot be saved/loaded directly. Save individual variable values and recreate in Actor Fully Loaded Event <3 Rama";
-				VSCREENMSGSEC(12, Msg);
-				UE_LOG(RamaSave,Error,TEXT("%s"), *Msg);
-				  
-				VSCREENMSGSEC(12, "~~~ Rama Save System Message ~~~");
-				
-				return false;
-			}  
-		} 
+		//Actor first, same order as VerifyActorAndComponentProperties
+		Check.Failed = FindUnloadableObjectProperty(Check.ActorOwner, *Check.OwnerProperties);
+		Check.bOwningActor = Check.Failed != nullptr;
+		if(!Check.Failed)
+		{
+			Check.Failed = FindUnloadableObjectProperty(SaveComps[Index], *Check.CompProperties);
+		}
+	});
+	
+	//~~~ Game Thread ~~~
+	//	Only the first failure, the one the serial checks would have stopped at
+	for(int32 v = 0; v < Checks.Num(); v++)
+	{
+		if(Checks[v].Failed)
+		{
+			ReportUnloadableObjectProperty(SaveComps[v], Checks[v].Failed, Checks[v].bOwningActor);
+			return SaveComps[v];
+		}
+	}
+	return nullptr;
+}
+
+UObjectProperty* URamaSaveLibrary::FindUnloadableObjectProperty(UObject* Container, const TArray<UObjectProperty*>& ObjectProperties)
+{
+	for(UObjectProperty* ObjProp : ObjectProperties)
+	{
+		UObject* Obj = ObjProp->GetObjectPropertyValue_InContainer(Container);
+		if(!Obj)
+		{
+			continue;
+		}
+
+		//Verfiy this is a load-able UObject Ptr !  <3 Rama
+		if(!URamaSaveUtility::VerifyObjectCanBeLoaded(Obj))
+		{
+			return ObjProp;
+		}
+	}
+	return nullptr;
+}
+
+void URamaSaveLibrary::ReportUnloadableObjectProperty(URamaSaveComponent* SaveComp, UObjectProperty* ObjProp, bool bOwningActor)
+{
+	VSCREENMSGSEC(12, "Save Process has been cancelled!");
+	if(bOwningActor)
+	{
+		VSCREENMSGSEC(12, "Please remove the invalid properties from the save name array, RamaSave_OwningActorVarsToSave"); 
+	}
+	else
+	{
+		VSCREENMSGSEC(12, "Please remove the invalid properties from the Rama Save Component");
 	}
+	
+	UClass* Class = bOwningActor ? SaveComp->GetOwner()->GetClass() : SaveComp->GetClass();
+	FString Msg = "The variable ~ " + ObjProp->GetName() + " ~ found in " + Class->GetName();
+	Msg += " >> This type of UObject Ptr cannot be saved/loaded directly. Save individual variable values and recreate in Actor Fully Loaded Event <3 Rama";
+	VSCREENMSGSEC(12, Msg);
+	UE_LOG(RamaSave,Error,TEXT("%s"), *Msg);
 	 
-	return true;
+	VSCREENMSGSEC(12, "~~~ Rama Save System Message ~~~");
 }
 
  
@@ -236,7 +281,7 @@ bool URamaSaveLibrary::RamaSave_CancelAsyncSaveProcess(UObject* WorldContextObje
 	return RamaEngine->RamaSaveAsync_Cancel();
 }
 
-void URamaSaveLibrary::RamaSave_SaveToFile(UObject* WorldContextObject, FString FileName, bool& FileIOSuccess, bool& AllComponentsSaved, FString SaveOnlyStreamingLevel,URamaSaveObject* StaticSaveData)
+void URamaSaveLibrary::RamaSave_SaveToFile(UObject* WorldContextObject, FString FileName, bool& FileIOSuccess, bool& AllComponentsSaved, FString SaveOnlyStreamingLevel,URamaSaveObject* StaticSaveData, ERamaSaveCodec Codec)
 {
 	if (!WorldContextObject) return;
 
@@ -258,7 +303,7 @@ void URamaSaveLibrary::RamaSave_SaveToFile(UObject* WorldContextObject, FString
 		return;
 	}
 	
-	RamaEngine->RamaSave_SaveToFile(FileName,FileIOSuccess,AllComponentsSaved,SaveOnlyStreamingLevel,StaticSaveData);
+	RamaEngine->RamaSave_SaveToFile(FileName,FileIOSuccess,AllComponentsSaved,SaveOnlyStreamingLevel,StaticSaveData,Codec);
 }
 	 
 
@@ -333,15 +378,13 @@ void URamaSaveLibrary::RamaSave_LoadFromFileWithTags(UObject* WorldContextObject
 		return; 
 	}
 	
-	//Victory Decompress File
-	TArray<uint8> Uncompressed_FromBinary;
-	if( !URamaSaveUtility::DecompressFromFile(FileName,Uncompressed_FromBinary))
+	//File is decompressed and parsed on a worker thread once the engine starts the load,
+	//	only its header is checked here, a file that fails later calls Async_LoadFailed
+	if(!CheckSaveFileHeader(FileName))
 	{
-		//File could not be loaded!
 		VSCREENMSG("Rama Save System ~ File was found but could not be loaded! " + FileName );
 		return;
 	}
-	
 	FileIOSuccess = true;
 	
 	//~~~
@@ -387,19 +430,111 @@ int32 URamaSaveLibrary::RamaSave_LoadStreamingStateFromFile(UObject* WorldContex
 		return 0; 
 	}
 	
-	//Victory Decompress File
 	TArray<uint8> Uncompressed_FromBinary;
-	if( !URamaSaveUtility::DecompressFromFile(FileName,Uncompressed_FromBinary))
+	
+	//Sectioned file, only the streaming section is read
+	TUniquePtr<FRamaSaveSectionReader> Sectioned(FRamaSaveSectionReader::OpenFile(FileName));
+	if(Sectioned.IsValid())
 	{
-		//File could not be loaded!
-		VSCREENMSG("Rama Save System ~ File was found but could not be loaded! " + FileName );
-		return 0;
+		if(!Sectioned->ReadSection(RamaSaveSectionFile::Streaming, Uncompressed_FromBinary))
+		{
+			VSCREENMSG("Rama Save System ~ File was found but could not be loaded! " + FileName );
+			return 0;
+		}
+		
+		TArray<FString> LevelNames;
+		TBitArray<> LevelVisible;
+		FMemoryReader MemoryReader(Uncompressed_FromBinary, true);
+		MemoryReader << LevelNames;
+		MemoryReader << LevelVisible;
+		if(MemoryReader.IsError() || LevelNames.Num() != LevelVisible.Num())
+		{
+			VSCREENMSG("Rama Save System ~ File was found but could not be loaded! " + FileName );
+			return 0;
+		}
+		
+		//StreamingLevelName=Visible, same as older files
+		StreamingLevelsStates.Empty(LevelNames.Num());
+		for(int32 v = 0; v < LevelNames.Num(); v++)
+		{
+			StreamingLevelsStates.Add(LevelNames[v] + FString("=") + BOOLSTR(LevelVisible[v]));
+		}
+		
+		FileIOSuccess = true;
+		return StreamingLevelsStates.Num();
+	}
+	
+	//Only the start of the file is needed, map it or decompress just the first block if possible
+	TUniquePtr<FArchive> FileReader(URamaSaveUtility::OpenFileReader(FileName, true, 1));
+	if(!FileReader.IsValid())
+	{
+		//Victory Decompress File
+		if( !URamaSaveUtility::DecompressFromFile(FileName,Uncompressed_FromBinary))
+		{
+			//File could not be loaded!
+			VSCREENMSG("Rama Save System ~ File was found but could not be loaded! " + FileName );
+			return 0;
+		}
+		FileReader.Reset(new FMemoryReader(Uncompressed_FromBinary, true));
 	}
 	
 	FileIOSuccess = true;
 	 
-	//Reader
-	FMemoryReader MemoryReader(Uncompressed_FromBinary, true);
+	return ReadStreamingState(*FileReader, StreamingLevelsStates);
+}
+
+bool URamaSaveLibrary::CheckSaveFileHeader(const FString& FileName)
+{
+	int32 SaveVersion = 0;
+	
+	//Sectioned file, OpenFile already checked the magic and the section table
+	TUniquePtr<FRamaSaveSectionReader> Sectioned(FRamaSaveSectionReader::OpenFile(FileName));
+	if(Sectioned.IsValid())
+	{
+		TArray<uint8> HeaderBytes;
+		if(!Sectioned->FindSection(RamaSaveSectionFile::Actors) || !Sectioned->ReadSection(RamaSaveSectionFile::Header, HeaderBytes))
+		{
+			return false;
+		}
+		
+		FMemoryReader Reader(HeaderBytes, true);
+		Reader << SaveVersion;
+		if(Reader.IsError())
+		{
+			return false;
+		}
+	}
+	else
+	{
+		//Older files, the block table and the first block only when the file allows it
+		TArray<uint8> Uncompressed_FromBinary;
+		TUniquePtr<FArchive> FileReader(URamaSaveUtility::OpenFileReader(FileName, true, 1));
+		if(!FileReader.IsValid())
+		{
+			if(!URamaSaveUtility::DecompressFromFile(FileName, Uncompressed_FromBinary))
+			{
+				return false;
+			}
+			FileReader.Reset(new FMemoryReader(Uncompressed_FromBinary, true));
+		}
+		
+		*FileReader << SaveVersion;
+		if(FileReader->IsError())
+		{
+			return false;
+		}
+	}
+	
+	if(SaveVersion > JOY_SAVE_VERSION)
+	{
+		UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ File is from a newer Rama Save System version! %s"), *FileName);
+		return false;
+	}
+	return SaveVersion > 0;
+}
+
+int32 URamaSaveLibrary::ReadStreamingState(FArchive& MemoryReader, TArray<FString>& StreamingLevelsStates)
+{
 	
 	//! #1
 	// Read version for this file format
@@ -445,56 +580,27 @@ void URamaSaveLibrary::GetAllRamaSaveComponentsWithTags(UObject* WorldContextObj
 	UWorld* const World = GEngine->GetWorldFromContextObject(WorldContextObject);
 	if(!World) return;
 	
-	for(TActorIterator<AActor> Itr(World); Itr; ++Itr)
+	FRamaSaveRegistry* Registry = FRamaSaveRegistry::Find(World);
+	if(!Registry) return;
+	
+	//Only the components of the requested streaming level, and with the tags if any were provided
+	TArray<URamaSaveComponent*> Found;
+	if(SaveTags.Num() > 0)
 	{
-		if(Itr->IsPendingKill()) continue;
-
-		URamaSaveComponent* SaveComp = Itr->FindComponentByClass<URamaSaveComponent>();
-		if(!SaveComp) continue;
-		if(!SaveComp->IsValidLowLevel()) continue;
-		if(SaveComp->IsPendingKill()) continue;
- 
-		//Streaming Level Filter
-		if(GetOnlyStreamingLevelName != "")
-		{
-			FString LevelPackageName = SaveComp->GetActorStreamingLevelPackageName();
-			  
-			if(GetOnlyStreamingLevelName != LevelPackageName)
-			{
-				continue;
-				//~~~~~~~
-			}
-		}
-		
-		//Tags Filter
-		if(SaveTags.Num() > 0)
-		{
-			if(SaveComp->RamaSave_HasAnyOfSaveTags(SaveTags))
-			{
-				RamaSaveComponents.Add(SaveComp);
-			}
-		} 
-		 
-		//Add all if no tags were provided!
-		else
-		{
-			RamaSaveComponents.Add(SaveComp);
-		}
+		Registry->GetComponentsWithTags(SaveTags, GetOnlyStreamingLevelName, Found);
+	}
+	else
+	{
+		Registry->GetComponents(GetOnlyStreamingLevelName, Found);
 	}
 	
-	//Object Iterator even with World Compare finds twice as many placed Rama Save Components
-	 
-	/*
-	for(TObjectIterator<URamaSaveComponent> Itr; Itr; ++Itr)
+	for(URamaSaveComponent* SaveComp : Found)
 	{
-		//Compare World to verify not a default object or viewport actor or other irrelevant actor
-		if(Itr->GetWorld() != World) continue;
-		if(!Itr->IsValidLowLevel()) continue;
-		if(Itr->GetOwner()->IsPendingKill()) continue;
+		//One per actor, the one FindComponentByClass returns
+		if(SaveComp->GetOwner()->FindComponentByClass<URamaSaveComponent>() != SaveComp) continue;
 		
-		RamaSaveComponents.Add(*Itr);
+		RamaSaveComponents.Add(SaveComp);
 	}
-	*/
 }
 void URamaSaveLibrary::GetAllRamaSaveActors(UObject* WorldContextObject, TArray<AActor*>& RamaSaveActors)
 {
@@ -512,27 +618,12 @@ void URamaSaveLibrary::GetAllRamaSaveActorsWithTags(UObject* WorldContextObject,
 	if(!World) return;
 	//~~~~~~~~~~~
 	
-	for(TActorIterator<AActor> Itr(World); Itr; ++Itr)
+	TArray<URamaSaveComponent*> SaveComps;
+	GetAllRamaSaveComponentsWithTags(World, SaveTags, SaveComps);
+	
+	for(URamaSaveComponent* SaveComp : SaveComps)
 	{
-		if(Itr->IsPendingKill()) continue;
-
-		URamaSaveComponent* SaveComp = Itr->FindComponentByClass<URamaSaveComponent>();
-		if(!SaveComp) continue;
-		if(!SaveComp->IsValidLowLevel()) continue;
-		if(SaveComp->IsPendingKill()) continue;
-		 
-		if(SaveTags.Num() > 0)
-		{  
-			if(SaveComp->RamaSave_HasAnyOfSaveTags(SaveTags))
-			{
-				RamaSaveActors.Add(*Itr);
-			}
-		}
-		//Add all if no tags were provided!
-		else
-		{
-			RamaSaveActors.Add(*Itr);
-		}
+		RamaSaveActors.Add(SaveComp->GetOwner());
 	}
 }
 void URamaSaveLibrary::RamaSave_ClearLevel(UObject* WorldContextObject, bool DontDestroyPlayers, FString ClearOnlyStreamingLevel)
@@ -542,33 +633,24 @@ void URamaSaveLibrary::RamaSave_ClearLevel(UObject* WorldContextObject, bool Don
 	UWorld* const World = GEngine->GetWorldFromContextObject(WorldContextObject);
 	if(!World) return;
 	 
+	FRamaSaveRegistry* Registry = FRamaSaveRegistry::Find(World);
+	if(!Registry) return;
+	
+	//Streaming Levels Filter, only the components of that level are visited
+	TArray<URamaSaveComponent*> LevelComponents;
+	Registry->GetComponents(ClearOnlyStreamingLevel, LevelComponents);
+	
 	TArray<AActor*> ToDestroy;
-	for(TObjectIterator<URamaSaveComponent> Itr; Itr; ++Itr)
-	{
-		//Compare World to verify not a default object or viewport actor or other irrelevant actor
-		if(Itr->GetWorld() != World) continue;
-		if(!Itr->IsValidLowLevel()) continue;
-		if(Itr->GetOwner()->IsPendingKill()) continue;
-		 
-		//Streaming Levels Filter
-		if(ClearOnlyStreamingLevel != "")
-		{
-			FString LevelPackageName = Itr->GetActorStreamingLevelPackageName();
-			if(LevelPackageName != ClearOnlyStreamingLevel)
-			{
-				//Dont destroy actor!
-				continue;
-			}
-		}
-		  
+	for(URamaSaveComponent* Each : LevelComponents)
+	{
 		//! FGUID Special Case
-		if(Itr->RamaSave_PersistentActorUniqueID.IsValid())
+		if(Each->RamaSave_PersistentActorUniqueID.IsValid())
 		{
-			if(Itr->RamaSave_LogPersistentActorGUID) UE_LOG(RamaSave,Log,TEXT("RamaSave ~ Loading ~ Not destroying actor who has a valid RamaSave_PersistentActorUniqueID %s"), *Itr->GetOwner()->GetName());
+			if(Each->RamaSave_LogPersistentActorGUID) UE_LOG(RamaSave,Log,TEXT("RamaSave ~ Loading ~ Not destroying actor who has a valid RamaSave_PersistentActorUniqueID %s"), *Each->GetOwner()->GetName());
 			continue;
 			//~~~~~~~
 		}
-		ToDestroy.Add(Itr->GetOwner());
+		ToDestroy.Add(Each->GetOwner());
 	}
 	
 	for(AActor* Each : ToDestroy)
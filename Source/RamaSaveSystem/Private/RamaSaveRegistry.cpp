@@ -0,0 +1,301 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#include "RamaSaveSystemPrivatePCH.h"
+#include "RamaSaveRegistry.h"
+
+#include "RamaSaveComponent.h"
+
+//Stale keys (worlds that were torn down) are dropped when the next world registers
+static TMap<TWeakObjectPtr<UWorld>, TUniquePtr<FRamaSaveRegistry>> Registries;
+
+FRamaSaveRegistry* FRamaSaveRegistry::Get(UWorld* World)
+{
+	check(IsInGameThread());
+	if(!World) return nullptr;
+	
+	if(TUniquePtr<FRamaSaveRegistry>* Found = Registries.Find(World))
+	{
+		return Found->Get();
+	}
+	
+	for(auto It = Registries.CreateIterator(); It; ++It)
+	{
+		if(!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+	return Registries.Add(World, MakeUnique<FRamaSaveRegistry>()).Get();
+}
+
+FRamaSaveRegistry* FRamaSaveRegistry::Find(UWorld* World)
+{
+	check(IsInGameThread());
+	if(!World) return nullptr;
+	
+	TUniquePtr<FRamaSaveRegistry>* Found = Registries.Find(World);
+	return Found ? Found->Get() : nullptr;
+}
+
+void FRamaSaveRegistry::Add(URamaSaveComponent* Comp)
+{
+	check(Comp);
+	
+	const FGuid& Guid = Comp->RamaSave_PersistentActorUniqueID;
+	
+	FEntry& Entry = Components.Add(Comp);
+	Entry.Guid = Guid;
+	
+	AActor* Owner = Comp->GetOwner();
+	if(ULevel* Level = Owner ? Owner->GetLevel() : nullptr)
+	{
+		Entry.Level = Level;
+		
+		FLevelBucket* Bucket = Levels.Find(Level);
+		if(!Bucket)
+		{
+			Bucket = &Levels.Add(Level);
+			Bucket->PackageName = GetLevelPackageName(Owner->GetWorld(), Level);
+		}
+		Bucket->Components.Add(Comp);
+	}
+	
+	Entry.SaveTags = Comp->RamaSave_SaveTags;
+	InternTags(Entry.SaveTags, Entry.Tags);
+	AddTags(Comp, Entry.Tags);
+	
+	if(!Guid.IsValid()) return;
+	
+	//Report it now, rather than loading into the wrong actor later
+	if(URamaSaveComponent* Other = ByGuid.FindRef(Guid).Get())
+	{
+		if(Other != Comp)
+		{
+			UE_LOG(RamaSave, Error, TEXT("Rama Save ~ %s and %s have the same RamaSave_PersistentActorUniqueID %s! Generate a new unique id for one of them, only %s will be loaded."), 
+				*GetNameSafe(Other->GetOwner()), *GetNameSafe(Comp->GetOwner()), *Guid.ToString(), *GetNameSafe(Other->GetOwner())
+			);
+		}
+	}
+	AddGuid(Comp, Guid);
+}
+
+void FRamaSaveRegistry::Remove(URamaSaveComponent* Comp)
+{
+	FEntry Entry;
+	if(!Components.RemoveAndCopyValue(Comp, Entry)) return;
+	
+	if(FLevelBucket* Bucket = Levels.Find(Entry.Level))
+	{
+		Bucket->Components.Remove(Comp);
+		
+		//Streamed out
+		if(Bucket->Components.Num() == 0)
+		{
+			Levels.Remove(Entry.Level);
+		}
+	}
+	
+	RemoveTags(Comp, Entry.Tags);
+	
+	if(Entry.Guid.IsValid())
+	{
+		RemoveGuid(Comp, Entry.Guid);
+	}
+}
+
+FString FRamaSaveRegistry::GetLevelPackageName(UWorld* World, ULevel* Level)
+{
+	//Consistency if it is the persistent level
+	if(!Level || !World || Level == World->PersistentLevel)
+	{
+		return "PersistentLevel";
+	}
+	
+	//! the only retention /acknowledgement of level streaming is via the outer name
+	UObject* Package = Level->GetOuter();
+	return Package ? Package->GetName() : "PersistentLevel";
+}
+
+void FRamaSaveRegistry::GetComponents(const FString& LevelPackageName, TArray<URamaSaveComponent*>& OutComponents) const
+{
+	for(const TPair<TWeakObjectPtr<ULevel>, FLevelBucket>& Level : Levels)
+	{
+		//Streaming Level Filter
+		if(!LevelPackageName.IsEmpty() && Level.Value.PackageName != LevelPackageName) continue;
+		
+		for(const TWeakObjectPtr<URamaSaveComponent>& Each : Level.Value.Components)
+		{
+			URamaSaveComponent* Comp = Each.Get();
+			if(!Comp || Comp->IsPendingKill()) continue;
+			
+			AActor* Owner = Comp->GetOwner();
+			if(!Owner || Owner->IsPendingKill()) continue;
+			
+			OutComponents.Add(Comp);
+		}
+	}
+}
+
+void FRamaSaveRegistry::GetComponentsWithTags(const TArray<FString>& SaveTags, const FString& LevelPackageName, TArray<URamaSaveComponent*>& OutComponents) const
+{
+	//A component with several of the tags is only added once
+	TSet<URamaSaveComponent*> Added;
+	
+	for(const FString& EachTag : SaveTags)
+	{
+		//Never interned, so no component has it
+		const FName Tag(*EachTag, FNAME_Find);
+		if(Tag == NAME_None) continue;
+		
+		const TSet<TWeakObjectPtr<URamaSaveComponent>>* Tagged = ByTag.Find(Tag);
+		if(!Tagged) continue;
+		
+		for(const TWeakObjectPtr<URamaSaveComponent>& Each : *Tagged)
+		{
+			URamaSaveComponent* Comp = Each.Get();
+			if(!Comp || Comp->IsPendingKill()) continue;
+			
+			AActor* Owner = Comp->GetOwner();
+			if(!Owner || Owner->IsPendingKill()) continue;
+			
+			//Streaming Level Filter
+			if(!LevelPackageName.IsEmpty())
+			{
+				const FEntry* Entry = Components.Find(Comp);
+				const FLevelBucket* Bucket = Entry ? Levels.Find(Entry->Level) : nullptr;
+				if(!Bucket || Bucket->PackageName != LevelPackageName) continue;
+			}
+			
+			bool bAlreadyAdded = false;
+			Added.Add(Comp, &bAlreadyAdded);
+			if(!bAlreadyAdded)
+			{
+				OutComponents.Add(Comp);
+			}
+		}
+	}
+}
+
+void FRamaSaveRegistry::UpdateTags(URamaSaveComponent* Comp)
+{
+	FEntry* Entry = Components.Find(Comp);
+	if(!Entry) return;
+	
+	//Every save asks, most components never change their tags
+	if(Comp->RamaSave_SaveTags == Entry->SaveTags) return;
+	Entry->SaveTags = Comp->RamaSave_SaveTags;
+	
+	TArray<FName> Tags;
+	InternTags(Entry->SaveTags, Tags);
+	if(Tags == Entry->Tags) return;
+	
+	RemoveTags(Comp, Entry->Tags);
+	Entry->Tags = MoveTemp(Tags);
+	AddTags(Comp, Entry->Tags);
+}
+
+void FRamaSaveRegistry::InternTags(const TArray<FString>& SaveTags, TArray<FName>& OutTags)
+{
+	OutTags.Reset(SaveTags.Num());
+	for(const FString& EachTag : SaveTags)
+	{
+		if(EachTag.IsEmpty()) continue;
+		OutTags.AddUnique(FName(*EachTag));
+	}
+}
+
+void FRamaSaveRegistry::AddTags(URamaSaveComponent* Comp, const TArray<FName>& Tags)
+{
+	for(const FName& Tag : Tags)
+	{
+		ByTag.FindOrAdd(Tag).Add(Comp);
+	}
+}
+
+void FRamaSaveRegistry::RemoveTags(URamaSaveComponent* Comp, const TArray<FName>& Tags)
+{
+	for(const FName& Tag : Tags)
+	{
+		TSet<TWeakObjectPtr<URamaSaveComponent>>* Tagged = ByTag.Find(Tag);
+		if(!Tagged) continue;
+		
+		Tagged->Remove(Comp);
+		if(Tagged->Num() == 0)
+		{
+			ByTag.Remove(Tag);
+		}
+	}
+}
+
+void FRamaSaveRegistry::AddGuid(URamaSaveComponent* Comp, const FGuid& Guid)
+{
+	TWeakObjectPtr<URamaSaveComponent>& Indexed = ByGuid.FindOrAdd(Guid);
+	if(Indexed.IsValid() && Indexed.Get() != Comp)
+	{
+		//Takes over if the first one unregisters
+		Duplicates.AddUnique(Guid, Comp);
+		return;
+	}
+	Indexed = Comp;
+}
+
+void FRamaSaveRegistry::RemoveGuid(URamaSaveComponent* Comp, const FGuid& Guid)
+{
+	TWeakObjectPtr<URamaSaveComponent>* Indexed = ByGuid.Find(Guid);
+	if(!Indexed || (Indexed->IsValid() && Indexed->Get() != Comp))
+	{
+		Duplicates.RemoveSingle(Guid, Comp);
+		return;
+	}
+	
+	for(auto It = Duplicates.CreateKeyIterator(Guid); It; ++It)
+	{
+		TWeakObjectPtr<URamaSaveComponent> Next = It.Value();
+		It.RemoveCurrent();
+		if(Next.IsValid())
+		{
+			*Indexed = Next;
+			return;
+		}
+	}
+	ByGuid.Remove(Guid);
+}
+
+URamaSaveComponent* FRamaSaveRegistry::FindByGuid(const FGuid& Guid)
+{
+	auto FindIndexed = [&]() -> URamaSaveComponent*
+	{
+		URamaSaveComponent* Comp = ByGuid.FindRef(Guid).Get();
+		return (Comp && Comp->RamaSave_PersistentActorUniqueID == Guid) ? Comp : nullptr;
+	};
+	
+	URamaSaveComponent* Comp = FindIndexed();
+	
+	//A GUID set after registering is picked up here, at most once a frame so missing actors stay cheap
+	if(!Comp && GuidsRefreshedFrame != GFrameCounter)
+	{
+		RefreshGuids();
+		Comp = FindIndexed();
+	}
+	return Comp;
+}
+
+void FRamaSaveRegistry::RefreshGuids()
+{
+	GuidsRefreshedFrame = GFrameCounter;
+	
+	ByGuid.Reset();
+	Duplicates.Reset();
+	
+	for(TPair<TWeakObjectPtr<URamaSaveComponent>, FEntry>& Each : Components)
+	{
+		URamaSaveComponent* Comp = Each.Key.Get();
+		if(!Comp) continue;
+		
+		FGuid& Guid = Each.Value.Guid;
+		Guid = Comp->RamaSave_PersistentActorUniqueID;
+		if(Guid.IsValid())
+		{
+			AddGuid(Comp, Guid);
+		}
+	}
+}
\ No newline at end of file
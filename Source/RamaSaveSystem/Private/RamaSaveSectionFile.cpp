@@ -0,0 +1,240 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#include "RamaSaveSystemPrivatePCH.h"
+#include "RamaSaveSectionFile.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Writer
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+FRamaSaveSectionWriter::FRamaSaveSectionWriter(FArchive* InFile)
+	: File(InFile)
+{
+	uint32 Magic = RamaSaveSectionFile::Magic;
+	uint32 Version = RamaSaveSectionFile::Version;
+	int32 NumSections = RamaSaveSectionFile::Count;
+	*File << Magic;
+	*File << Version;
+	*File << NumSections;
+
+	//Placeholder table, same size as the real one
+	TablePos = File->Tell();
+	Sections.SetNum(NumSections);
+	for(FRamaSaveSectionEntry& Each : Sections)
+	{
+		*File << Each;
+	}
+}
+
+FRamaSaveSectionWriter::~FRamaSaveSectionWriter()
+{
+	Close();
+}
+
+FRamaSaveSectionWriter* FRamaSaveSectionWriter::CreateFile(const FString& FullFilePath)
+{
+	FArchive* FileWriter = IFileManager::Get().CreateFileWriter(*FullFilePath);
+	if(!FileWriter)
+	{
+		return nullptr;
+	}
+	return new FRamaSaveSectionWriter(FileWriter);
+}
+
+FArchive& FRamaSaveSectionWriter::BeginSection(uint32 Id, ERamaSaveCodec Codec)
+{
+	check(File && !Current.IsValid() && Id < RamaSaveSectionFile::Count);
+
+	FRamaSaveSectionEntry& Entry = Sections[Id];
+	Entry.Id = Id;
+	Entry.Offset = File->Tell();
+	Entry.Codec = (uint8)Codec;
+
+	CurrentId = Id;
+	Current.Reset(new FRamaSaveBlockWriter(File, false, Codec));
+	return *Current;
+}
+
+void FRamaSaveSectionWriter::EndSection()
+{
+	if(!Current.IsValid()) return;
+
+	if(!Current->Close())
+	{
+		bError = true;
+	}
+
+	FRamaSaveSectionEntry& Entry = Sections[CurrentId];
+	Entry.StoredSize = File->Tell() - Entry.Offset;
+	Entry.RawSize = Current->TotalSize();
+
+	Current.Reset();
+}
+
+void FRamaSaveSectionWriter::WriteSection(uint32 Id, const TArray<uint8>& Raw, ERamaSaveCodec Codec)
+{
+	FArchive& Ar = BeginSection(Id, Codec);
+	Ar.Serialize(const_cast<uint8*>(Raw.GetData()), Raw.Num());
+	EndSection();
+}
+
+bool FRamaSaveSectionWriter::Close()
+{
+	if(!File)
+	{
+		return !bError;
+	}
+	EndSection();
+
+	//~~~ Patch Table ~~~
+	const int64 EndPos = File->Tell();
+	File->Seek(TablePos);
+	for(FRamaSaveSectionEntry& Each : Sections)
+	{
+		*File << Each;
+	}
+	File->Seek(EndPos);
+
+	if(File->IsError() || !File->Close())
+	{
+		bError = true;
+	}
+	delete File;
+	File = nullptr;
+
+	return !bError;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Reader
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+FRamaSaveSectionReader::FRamaSaveSectionReader(FArchive* InFile, const FString& InFileName)
+	: File(InFile)
+	, FileName(InFileName)
+{
+}
+
+FRamaSaveSectionReader::~FRamaSaveSectionReader()
+{
+	if(File)
+	{
+		File->Close();
+		delete File;
+	}
+}
+
+FRamaSaveSectionReader* FRamaSaveSectionReader::OpenFile(const FString& FullFilePath)
+{
+	FArchive* FileReader = IFileManager::Get().CreateFileReader(*FullFilePath);
+	if(!FileReader)
+	{
+		return nullptr;
+	}
+	FRamaSaveSectionReader* Reader = new FRamaSaveSectionReader(FileReader, FullFilePath);
+
+	//~~~ Header ~~~
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int32 NumSections = 0;
+	*FileReader << Magic;
+	if(Magic != RamaSaveSectionFile::Magic)
+	{
+		//Older file, not an error
+		delete Reader;
+		return nullptr;
+	}
+	*FileReader << Version;
+	*FileReader << NumSections;
+
+	if(FileReader->IsError() || Version > RamaSaveSectionFile::Version || NumSections < 0 || NumSections > 1024)
+	{
+		UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ Section table is not valid or from a newer version! %s"), *FullFilePath);
+		delete Reader;
+		return nullptr;
+	}
+
+	//~~~ Table ~~~
+	Reader->Sections.SetNum(NumSections);
+	for(FRamaSaveSectionEntry& Each : Reader->Sections)
+	{
+		*FileReader << Each;
+		if(Each.Offset < 0 || Each.StoredSize < 0 || Each.Offset + Each.StoredSize > FileReader->TotalSize())
+		{
+			UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ Section table is corrupt! %s"), *FullFilePath);
+			delete Reader;
+			return nullptr;
+		}
+	}
+	if(FileReader->IsError())
+	{
+		delete Reader;
+		return nullptr;
+	}
+	return Reader;
+}
+
+const FRamaSaveSectionEntry* FRamaSaveSectionReader::FindSection(uint32 Id) const
+{
+	return Sections.FindByPredicate([&](const FRamaSaveSectionEntry& Each) { return Each.Id == Id && Each.StoredSize > 0; });
+}
+
+bool FRamaSaveSectionReader::ReadSection(uint32 Id, TArray<uint8>& OutRaw)
+{
+	const FRamaSaveSectionEntry* Entry = FindSection(Id);
+	if(!Entry || Entry->StoredSize > MAX_int32)
+	{
+		return false;
+	}
+
+	TArray<uint8> Stored;
+	Stored.SetNumUninitialized((int32)Entry->StoredSize);
+	File->Seek(Entry->Offset);
+	File->Serialize(Stored.GetData(), Stored.Num());
+	if(File->IsError())
+	{
+		return false;
+	}
+
+	return URamaSaveUtility::DecompressBlocks(Stored, OutRaw);
+}
+
+FArchive* FRamaSaveSectionReader::OpenSection(uint32 Id, bool bAllowStreaming, TArray<uint8>& OutBuffer)
+{
+	const FRamaSaveSectionEntry* Entry = FindSection(Id);
+	if(!Entry)
+	{
+		return nullptr;
+	}
+
+	//Zero copy
+	if(Entry->Codec == (uint8)ERamaSaveCodec::None)
+	{
+		if(FArchive* Mapped = FRamaSaveMappedReader::OpenFile(FileName, Entry->Offset, Entry->StoredSize))
+		{
+			return Mapped;
+		}
+	}
+
+	//A window at a time, through a file handle of its own
+	if(bAllowStreaming)
+	{
+		FArchive* SectionFile = IFileManager::Get().CreateFileReader(*FileName);
+		if(!SectionFile)
+		{
+			return nullptr;
+		}
+
+		FRamaSaveBlockReader* Reader = new FRamaSaveBlockReader(new FRamaSaveRangeReader(SectionFile, true, Entry->Offset, Entry->StoredSize), true);
+		if(!Reader->IsValid())
+		{
+			delete Reader;
+			return nullptr;
+		}
+		return Reader;
+	}
+
+	//All at once
+	if(!ReadSection(Id, OutBuffer))
+	{
+		return nullptr;
+	}
+	return new FMemoryReader(OutBuffer, true);
+}
\ No newline at end of file
@@ -0,0 +1,347 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#include "RamaSaveSystemPrivatePCH.h"
+#include "RamaSaveSnapshot.h"
+
+#include "StructuredArchiveFromArchive.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Property Block
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+FRamaSavePropertyBlock::~FRamaSavePropertyBlock()
+{
+	DestroyValues();
+}
+
+void FRamaSavePropertyBlock::CopyValues()
+{
+	check(!bCopied);
+	
+	//Offsets first so the whole block is one allocation
+	TArray<int32, TInlineAllocator<16>> Offsets;
+	int32 Size = 0;
+	for(UProperty* Property : Properties)
+	{
+		Size = Align(Size, Property->GetMinAlignment());
+		Offsets.Add(Size);
+		Size += Property->GetSize();
+	}
+	Memory.SetNumUninitialized(Size);
+	
+	for(int32 v = 0; v < Properties.Num(); v++)
+	{
+		uint8* Copy = Memory.GetData() + Offsets[v];
+		Properties[v]->InitializeValue(Copy);
+		Properties[v]->CopyCompleteValue(Copy, Values[v]);
+		Values[v] = Copy;
+	}
+	bCopied = true;
+}
+
+void FRamaSavePropertyBlock::DestroyValues()
+{
+	if(!bCopied) return;
+	
+	for(int32 v = 0; v < Properties.Num(); v++)
+	{
+		Properties[v]->DestroyValue(Values[v]);
+	}
+	Values.Reset();
+	Memory.Empty();
+	bCopied = false;
+}
+
+void FRamaSavePropertyBlock::WriteHeader(FRamaSaveArchive& Ar)
+{
+	URamaSaveComponent::SavePropertyBlockHeader(Ar, Properties);
+}
+
+void FRamaSavePropertyBlock::WriteValues(FRamaSaveArchive& Ar, const FString& ActorName)
+{
+	for(int32 v = 0; v < Properties.Num(); v++)
+	{
+		const int32 MissingBefore = Ar.Strings ? Ar.Strings->MissingObjectPaths : 0;
+		
+		URamaSaveComponent::SavePropertyAt(Ar, Properties[v], Values[v]);
+		
+		if(Ar.Strings && Ar.Strings->MissingObjectPaths != MissingBefore)
+		{
+			UE_LOG(RamaSave, Warning, TEXT("Rama Save System ~ %s ~ %s references an object whose path was not collected, it was saved as null"), *ActorName, *Properties[v]->GetName());
+		}
+	}
+}
+
+void FRamaSavePropertyBlock::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	if(!bCopied) return;
+	
+	for(int32 v = 0; v < Properties.Num(); v++)
+	{
+		UProperty* Property = Properties[v];
+		TArray<const UStructProperty*> EncounteredStructProps;
+		if(!Property->ContainsObjectReference(EncounteredStructProps))
+		{
+			continue;
+		}
+		
+		//Every element of static arrays, all of them were copied
+		for(int32 i = 0; i < Property->ArrayDim; i++)
+		{
+			Property->SerializeItem(FStructuredArchiveFromArchive(Collector.GetVerySlowReferenceCollectorArchive()).GetSlot(), Values[v] + i * Property->ElementSize);
+		}
+	}
+}
+
+namespace RamaSaveObjectPaths
+{
+	//Only visits references, every object found gets its path once
+	class FCollector : public FArchiveUObject
+	{
+	public:
+		FCollector(TMap<UObject*, FString>& InObjectPaths)
+			: ObjectPaths(InObjectPaths)
+		{
+			ArIsObjectReferenceCollector = true;
+		}
+		
+		virtual FArchive& operator<<(UObject*& Object) override
+		{
+			if(Object && !ObjectPaths.Contains(Object))
+			{
+				ObjectPaths.Add(Object, Object->GetPathName());
+			}
+			return *this;
+		}
+		
+	private:
+		TMap<UObject*, FString>& ObjectPaths;
+	};
+}
+
+void FRamaSavePropertyBlock::CollectObjectPaths(TMap<UObject*, FString>& ObjectPaths)
+{
+	RamaSaveObjectPaths::FCollector Collector(ObjectPaths);
+	for(int32 v = 0; v < Properties.Num(); v++)
+	{
+		UProperty* Property = Properties[v];
+		TArray<const UStructProperty*> EncounteredStructProps;
+		if(!Property->ContainsObjectReference(EncounteredStructProps))
+		{
+			continue;
+		}
+		
+		for(int32 i = 0; i < Property->ArrayDim; i++)
+		{
+			Property->SerializeItem(FStructuredArchiveFromArchive(Collector).GetSlot(), Values[v] + i * Property->ElementSize);
+		}
+	}
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Actor Snapshot
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void FRamaSaveActorSnapshot::CopyValues()
+{
+	Self.CopyValues();
+	Owner.CopyValues();
+	SubComponents.CopyValues();
+	for(FRamaSavePropertyBlock& Each : CompBlocks)
+	{
+		Each.CopyValues();
+	}
+}
+
+void FRamaSaveActorSnapshot::DestroyValues()
+{
+	Self.DestroyValues();
+	Owner.DestroyValues();
+	SubComponents.DestroyValues();
+	for(FRamaSavePropertyBlock& Each : CompBlocks)
+	{
+		Each.DestroyValues();
+	}
+}
+
+void FRamaSaveActorSnapshot::CollectObjectPaths(TMap<UObject*, FString>& ObjectPaths)
+{
+	Self.CollectObjectPaths(ObjectPaths);
+	Owner.CollectObjectPaths(ObjectPaths);
+	SubComponents.CollectObjectPaths(ObjectPaths);
+	for(FRamaSavePropertyBlock& Each : CompBlocks)
+	{
+		Each.CollectObjectPaths(ObjectPaths);
+	}
+}
+
+void FRamaSaveActorSnapshot::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Self.AddReferencedObjects(Collector);
+	Owner.AddReferencedObjects(Collector);
+	SubComponents.AddReferencedObjects(Collector);
+	for(FRamaSavePropertyBlock& Each : CompBlocks)
+	{
+		Each.AddReferencedObjects(Collector);
+	}
+}
+
+void FRamaSaveActorSnapshot::AddLayouts(FRamaSaveLayoutTable& Layouts, FRamaSaveStringTable& Strings)
+{
+	Layouts.Add(Strings, Self.Properties);
+	Layouts.Add(Strings, Owner.Properties);
+	
+	if(!bSubComponentsPerComp)
+	{
+		Layouts.Add(Strings, SubComponents.Properties);
+		return;
+	}
+	for(FRamaSavePropertyBlock& Each : CompBlocks)
+	{
+		Layouts.Add(Strings, Each.Properties);
+	}
+}
+
+bool FRamaSaveActorSnapshot::Write(FRamaSaveArchive& Ar)
+{
+	const int64 RecordBegin = Ar.Tell();
+	const int32 MissingBefore = Ar.Strings ? Ar.Strings->MissingObjectPaths : 0;
+	
+	//Every object reference in the values, as the record is written
+	ObjectIndices.Reset();
+	TArray<uint32>* OuterReferences = Ar.ObjectReferences;
+	Ar.ObjectReferences = &ObjectIndices;
+	
+	//! #4 Actor Byte Chunk, sized so it can be skipped
+	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	Ar.SaveSized([&](FRamaSaveArchive& RecordAr)
+	{
+		//! #4 String Actor Class
+		RecordAr.SerializeString(ActorClass);
+		 
+		//! #4 String Actor Class Path
+		RecordAr.SerializeString(ActorClassFullPath);
+		
+		//! #4.5 FGUID !
+		RecordAr << PersistentActorUniqueID;
+		
+		//! 4.7333 Actor Tags
+		RecordAr << SaveTags;
+		
+		//! 4.9 Level Streaming
+		RecordAr.SerializeString(LevelPackageName);
+		
+		//! #5 Serialize Properties
+		Self.WriteHeader(RecordAr);
+		Self.WriteValues(RecordAr, ActorName);
+		
+		//! #6 Total Count
+		Owner.WriteHeader(RecordAr);
+		
+		//! #7 Pawn
+		if(bPawn)
+		{
+			RecordAr << bIsPlayer;
+			RecordAr << PawnVelocity;
+			RecordAr << ControlRotation;
+			RecordAr << PlayerIndex;
+		}
+		
+		//!#9 Properties
+		Owner.WriteValues(RecordAr, ActorName);
+		
+		//Physics
+		if(bPhysics)
+		{
+			//Whether this file has any Physics save data
+			bool HavePhysicsSaveData = true;
+			RecordAr << HavePhysicsSaveData;
+			
+			//Save count, so if count doesnt match, know to skip section
+			int32 PrimitiveCount = Simulating.Num();
+			RecordAr << PrimitiveCount;
+			
+			//Save RB States, sized so the section can be skipped
+			RecordAr.SaveSized([&](FRamaSaveArchive& PhysicsAr)
+			{
+				int32 StateIndex = 0;
+				for(bool IsSimulatingPhysics : Simulating)
+				{
+					PhysicsAr << IsSimulatingPhysics;
+					if(IsSimulatingPhysics)
+					{
+						PhysicsAr << PhysStates[StateIndex++];
+					}
+				}
+			});
+		}
+		
+		//Sub Components
+		if(!bSubComponentsPerComp)
+		{
+			//! Total (or layout, its names are looked up across all the comps when loading)
+			SubComponents.WriteHeader(RecordAr);
+			SubComponents.WriteValues(RecordAr, ActorName);
+			return;
+		}
+		
+		//#SC_1
+		int32 TotalCompEntries = CompBlocks.Num();
+		RecordAr << TotalCompEntries;
+		
+		for(int32 v = 0; v < CompBlocks.Num(); v++)
+		{
+			FRamaSavePropertyBlock& Block = CompBlocks[v];
+			
+			//#SC_2
+			RecordAr.SerializeName(CompNames[v]);
+			
+			//#SC_3 sized, might have to skip if comp removed
+			RecordAr.SaveSized([&](FRamaSaveArchive& CompAr)
+			{
+				//#SC_4
+				if(CompAr.Layouts)
+				{
+					Block.WriteHeader(CompAr);
+				}
+				else
+				{
+					int32 CompPropertiesTotal = Block.Properties.Num();
+					CompAr << CompPropertiesTotal;
+				}
+				
+				//#SC_5 - #SC_7
+				Block.WriteValues(CompAr, ActorName);
+			});
+		}
+	});
+	
+	Ar.ObjectReferences = OuterReferences;
+	
+	//So filtered loads can find this record without reading every header
+	if(Ar.Directory && Ar.Strings)
+	{
+		Ar.Directory->Add(*Ar.Strings, RecordBegin, ActorClass, LevelPackageName, PersistentActorUniqueID, SaveTags, ObjectIndices);
+	}
+	
+	return !Ar.Strings || Ar.Strings->MissingObjectPaths == MissingBefore;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Batch
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool FRamaSaveSnapshotBatch::Add(UWorld* World, URamaSaveComponent* Comp)
+{
+	if(!Comp->RamaSave_ShouldSaveActor)
+	{
+		//Actor is not being saved right now per user request.
+		return true;
+	}
+	
+	TUniquePtr<FRamaSaveActorSnapshot> Snapshot = MakeUnique<FRamaSaveActorSnapshot>();
+	if(!Comp->TakeSnapshot(World, *Snapshot))
+	{
+		return false;
+	}
+	Snapshot->CopyValues();
+	Snapshot->CollectObjectPaths(ObjectPaths);
+	Snapshots.Add(Snapshot.Release());
+	return true;
+}
\ No newline at end of file
@@ -3,6 +3,10 @@
 #include "RamaSaveUtility.h"
 #include "ArchiveSaveCompressedProxy.h"
 #include "ArchiveLoadCompressedProxy.h"
+#include "ParallelFor.h"
+#include "RamaSaveSystemSettings.h"
+#include "RamaSaveBlockArchive.h"
+#include "RamaSaveSectionFile.h"
 
 ////HTML Save and Load 
 //#if PLATFORM_HTML5_BROWSER
@@ -22,10 +26,112 @@ bool URamaSaveUtility::IsIllegalForSavingLoading(UClass* Class)
 			 
 }
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Save Buffer Pool
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+TArray<uint8> FRamaSaveBufferPool::Acquire()
+{
+	TArray<uint8> Buffer;
+	if(FreeBuffers.Num())
+	{
+		Buffer = FreeBuffers.Pop(false);
+	}
+	Buffer.Reset();
+	
+	//Room for the world to grow a bit since the last save
+	const int64 Hint = FMath::Min<int64>(LastSaveSize + LastSaveSize / 8, MAX_int32);
+	if(Buffer.Max() < Hint)
+	{
+		Buffer.Reserve((int32)Hint);
+	}
+	return Buffer;
+}
+
+void FRamaSaveBufferPool::Release(TArray<uint8>&& Buffer)
+{
+	//One save at a time, sync or async, so a couple is plenty
+	if(Buffer.Max() <= 0 || FreeBuffers.Num() >= 2) return;
+	
+	Buffer.Reset();
+	FreeBuffers.Add(MoveTemp(Buffer));
+}
+
+void FRamaSaveBufferPool::Trim()
+{
+	FreeBuffers.Empty();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Block Framed Files, layout in RamaSaveBlockArchive.h
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ERamaSaveCodec URamaSaveUtility::ResolveCodec(ERamaSaveCodec Codec)
+{
+	if(Codec == ERamaSaveCodec::UseProjectDefault)
+	{
+		Codec = URamaSaveSystemSettings::Get()->CompressionCodec;
+	}
+	
+	//Project setting itself can't defer to anything
+	return (Codec == ERamaSaveCodec::UseProjectDefault) ? ERamaSaveCodec::Zlib : Codec;
+}
+
+bool URamaSaveUtility::IsBlockFramed(const TArray<uint8>& FileData)
+{
+	if(FileData.Num() < sizeof(uint32)) return false;
+	
+	FMemoryReader Reader(FileData, true);
+	uint32 Magic = 0;
+	Reader << Magic;
+	return Magic == RamaSaveBlockFile::Magic;
+}
+
+bool URamaSaveUtility::CompressBlocks(const TArray<uint8>& Uncompressed, TArray<uint8>& FileData, ERamaSaveCodec Codec)
+{
+	FMemoryWriter MemoryWriter(FileData, true);
+	
+	FRamaSaveBlockWriter Writer(&MemoryWriter, false, Codec);
+	Writer.Serialize(const_cast<uint8*>(Uncompressed.GetData()), Uncompressed.Num());
+	return Writer.Close();
+}
+
+bool URamaSaveUtility::DecompressBlocks(const TArray<uint8>& FileData, TArray<uint8>& Uncompressed)
+{
+	FMemoryReader Reader(FileData, true);
+	
+	FRamaSaveBlockHeader Header;
+	if(!Header.Read(Reader))
+	{
+		return false;
+	}
+	if(Header.UncompressedSize > MAX_int32)
+	{
+		UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ File is too large to load at once, turn on Streaming Save Load in the project settings!"));
+		return false;
+	}
+	
+	//~~~ Decompress every block on the task graph ~~~
+	Uncompressed.SetNumUninitialized((int32)Header.UncompressedSize);
+	
+	FThreadSafeBool bFailed = false;
+	ParallelFor(Header.NumBlocks, [&](int32 BlockIndex)
+	{
+		if(!RamaSaveBlockFile::DecompressBlock(
+			Header.IsStoredRaw(BlockIndex),
+			Uncompressed.GetData() + (int64)BlockIndex * Header.BlockSize, Header.GetRawSize(BlockIndex),
+			FileData.GetData() + Header.FileOffsets[BlockIndex], Header.StoredSizes[BlockIndex]
+		))
+		{
+			bFailed = true;
+		}
+	});
+	
+	return !bFailed;
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Save To Compressed File, by Rama
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-bool URamaSaveUtility::CompressAndWriteToFile(TArray<uint8>& Uncompressed, const FString& FullFilePath)
+bool URamaSaveUtility::CompressAndWriteToFile(TArray<uint8>& Uncompressed, const FString& FullFilePath, ERamaSaveCodec Codec)
 {
 	//~~~ No Data ~~~ 
 	if (Uncompressed.Num() <= 0) return false;
@@ -46,33 +152,77 @@ bool URamaSaveUtility::CompressAndWriteToFile(TArray<uint8>& Uncompressed, const
 #else 
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~
 	//					Compress
-	//~~~ Compress File ~~~
-	//tmp compressed data array
-	TArray<uint8> CompressedData;
-	FArchiveSaveCompressedProxy Compressor(CompressedData, ECompressionFlags::COMPRESS_ZLIB);
-	
-	//Send entire binary array/archive to compressor
-	Compressor << Uncompressed;
-	
-	//send archive serialized data to binary array
-	Compressor.Flush();
-	
-	if (!FFileHelper::SaveArrayToFile(CompressedData, *FullFilePath))
+	//~~~ Compress File, one block per core ~~~
+	//	Straight into the file handle, one window of blocks at a time
+	FRamaSaveBlockWriter* Writer = FRamaSaveBlockWriter::CreateFile(FullFilePath, Codec);
+	if(!Writer)
 	{
 		return false;
 	}
 	
+	Writer->Serialize(Uncompressed.GetData(), Uncompressed.Num());
+	bool Success = Writer->Close();
+	delete Writer;
+	
 	//~~~ Clean Up ~~~
+	//	Uncompressed is left to the caller, so it can go back to the save buffer pool
 	
-	//~~~ Free Binary Arrays ~~~
-	Compressor.FlushCache();
-	CompressedData.Empty();
-	Uncompressed.Empty();
+	if(!Success)
+	{
+		UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ File IO Error writing %s"), *FullFilePath);
+		return false;
+	}
 #endif 
 	
 	return true;
 } 
 
+bool URamaSaveUtility::WriteSectionedFile(const FString& FullFilePath, const FRamaSaveFileSections& Sections, const TArray<uint8>& Actors, ERamaSaveCodec Codec)
+{
+	FRamaSaveSectionWriter* Writer = FRamaSaveSectionWriter::CreateFile(FullFilePath);
+	if(!Writer)
+	{
+		return false;
+	}
+	
+	Writer->WriteSection(RamaSaveSectionFile::Header, Sections.Header, Codec);
+	Writer->WriteSection(RamaSaveSectionFile::Streaming, Sections.Streaming, Codec);
+	Writer->WriteSection(RamaSaveSectionFile::StaticData, Sections.StaticData, Codec);
+	Writer->WriteSection(RamaSaveSectionFile::Actors, Actors, Codec);
+	Writer->WriteSection(RamaSaveSectionFile::Strings, Sections.Strings, Codec);
+	Writer->WriteSection(RamaSaveSectionFile::Directory, Sections.Directory, Codec);
+	Writer->WriteSection(RamaSaveSectionFile::Layouts, Sections.Layouts, Codec);
+	
+	bool Success = Writer->Close();
+	delete Writer;
+	
+	if(!Success)
+	{
+		UE_LOG(RamaSave, Error, TEXT("Rama Save System ~ File IO Error writing %s"), *FullFilePath);
+		return false;
+	}
+	return true;
+}
+
+FArchive* URamaSaveUtility::OpenFileReader(const FString& FullFilePath, bool bAllowStreaming, int32 WindowBlocks)
+{
+#if PLATFORM_HTML5_BROWSER
+	return nullptr;
+#else
+	//Zero copy
+	if(FArchive* Mapped = FRamaSaveMappedReader::OpenFile(FullFilePath))
+	{
+		return Mapped;
+	}
+	
+	if(bAllowStreaming)
+	{
+		return FRamaSaveBlockReader::OpenFile(FullFilePath, WindowBlocks);
+	}
+	return nullptr;
+#endif
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // 	Decompress From File, by Rama
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -110,7 +260,13 @@ bool URamaSaveUtility::DecompressFromFile(const FString& FullFilePath, TArray<ui
 		//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	}
 	
-	//~~~ Decompress File ~~~
+	//~~~ Block framed? Decompress one block per core ~~~
+	if(IsBlockFramed(CompressedData))
+	{
+		return DecompressBlocks(CompressedData, Uncompressed);
+	}
+	
+	//~~~ Decompress File, old single stream format ~~~
 	FArchiveLoadCompressedProxy Decompressor(CompressedData, ECompressionFlags::COMPRESS_ZLIB);
 	
 	//Decompression Error?
@@ -0,0 +1,474 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#include "RamaSaveSystemPrivatePCH.h"
+#include "RamaSaveArchive.h"
+#include "RamaSaveComponent.h"
+
+#include "Misc/AutomationTest.h"
+#include "Components/ChildActorComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/*
+	Object references, FNames and arrays of FNames saved and loaded through the property value path,
+	the way actor records write them, with the string table written and read back in between.
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRamaSaveReferenceRoundTripTest, "RamaSaveSystem.Archive.ReferenceRoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRamaSaveReferenceRoundTripTest::RunTest(const FString& Parameters)
+{
+	UChildActorComponent* Source = NewObject<UChildActorComponent>();
+	UChildActorComponent* Dest = NewObject<UChildActorComponent>();
+	
+	//A class is an object reference whose path is always there to load
+	UObjectPropertyBase* ClassProperty = FindField<UObjectPropertyBase>(UChildActorComponent::StaticClass(), TEXT("ChildActorClass"));
+	UNameProperty* NameProperty = FindField<UNameProperty>(UChildActorComponent::StaticClass(), TEXT("AttachSocketName"));
+	UArrayProperty* NamesProperty = FindField<UArrayProperty>(UChildActorComponent::StaticClass(), TEXT("ComponentTags"));
+	if(!TestNotNull(TEXT("ChildActorClass property"), ClassProperty) || !TestNotNull(TEXT("AttachSocketName property"), NameProperty) || !TestNotNull(TEXT("ComponentTags property"), NamesProperty))
+	{
+		return false;
+	}
+	TArray<UProperty*> Properties = { ClassProperty, NameProperty, NamesProperty };
+	
+	TestFalse(TEXT("Object property is not raw"), URamaSaveComponent::IsRawProperty(ClassProperty));
+	TestFalse(TEXT("Name property is not raw"), URamaSaveComponent::IsRawProperty(NameProperty));
+	TestFalse(TEXT("Name array inner is not raw"), URamaSaveComponent::IsRawProperty(NamesProperty->Inner));
+	
+	ClassProperty->SetObjectPropertyValue_InContainer(Source, AActor::StaticClass());
+	NameProperty->SetPropertyValue_InContainer(Source, FName(TEXT("RamaSaveTestSocket")));
+	Source->ComponentTags = { FName(TEXT("RamaSaveTestTagA")), FName(TEXT("RamaSaveTestTagB")) };
+	
+	//~~~ Save ~~~
+	TArray<uint8> RecordBytes;
+	TArray<uint8> StringBytes;
+	{
+		FRamaSaveStringTable Strings;
+		FMemoryWriter Writer(RecordBytes, true);
+		FRamaSaveArchive Ar(Writer, false, &Strings);
+		for(UProperty* Property : Properties)
+		{
+			URamaSaveComponent::SaveProperty(Ar, Property, Source);
+		}
+		
+		//Through the table, not as memory
+		TestTrue(TEXT("Object path is in the string table"), Strings.Strings.Contains(AActor::StaticClass()->GetPathName()));
+		TestTrue(TEXT("FName is in the string table"), Strings.Strings.Contains(TEXT("RamaSaveTestSocket")));
+		TestTrue(TEXT("FName array entry is in the string table"), Strings.Strings.Contains(TEXT("RamaSaveTestTagB")));
+		
+		FMemoryWriter StringsWriter(StringBytes, true);
+		StringsWriter << Strings;
+	}
+	
+	//~~~ Load ~~~
+	{
+		FRamaSaveStringTable Strings;
+		FMemoryReader StringsReader(StringBytes, true);
+		StringsReader << Strings;
+		
+		FMemoryReader Reader(RecordBytes, true);
+		FRamaSaveArchive Ar(Reader, true, &Strings);
+		for(UProperty* Property : Properties)
+		{
+			FName PropertyName;
+			const int64 EndPos = URamaSaveComponent::LoadPropertyHeader(Ar, PropertyName);
+			TestTrue(TEXT("Property name"), PropertyName == Property->GetFName());
+			URamaSaveComponent::LoadPropertyValue(Ar, Property, Property->ContainerPtrToValuePtr<uint8>(Dest), EndPos);
+			TestTrue(TEXT("Property fully read"), Ar.Tell() == EndPos);
+		}
+		TestFalse(TEXT("Archive error"), Ar.IsError());
+	}
+	
+	TestTrue(TEXT("Object reference"), ClassProperty->GetObjectPropertyValue_InContainer(Dest) == AActor::StaticClass());
+	TestTrue(TEXT("FName"), NameProperty->GetPropertyValue_InContainer(Dest) == FName(TEXT("RamaSaveTestSocket")));
+	TestTrue(TEXT("FName array"), Dest->ComponentTags == Source->ComponentTags);
+	return true;
+}
+
+/*
+	Sized blobs nested in each other, small and past the one byte packed size, 
+	skipped whole by their end position or read through.
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRamaSaveSizedSkipTest, "RamaSaveSystem.Archive.SizedSkip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRamaSaveSizedSkipTest::RunTest(const FString& Parameters)
+{
+	const int32 BlobSizes[] = { 0, 1, 127, 128, 5000 };
+	
+	TArray<uint8> Bytes;
+	{
+		FRamaSaveStringTable Strings;
+		FMemoryWriter Writer(Bytes, true);
+		FRamaSaveArchive Ar(Writer, false, &Strings);
+		for(int32 Size : BlobSizes)
+		{
+			Ar.SaveSized([&](FRamaSaveArchive& OuterAr)
+			{
+				int32 Marker = Size;
+				OuterAr << Marker;
+				OuterAr.SaveSized([&](FRamaSaveArchive& InnerAr)
+				{
+					for(int32 v = 0; v < Size; v++)
+					{
+						uint8 Byte = (uint8)v;
+						InnerAr << Byte;
+					}
+				});
+				FString After = TEXT("RamaSaveTestAfterInner");
+				OuterAr.SerializeString(After);
+			});
+		}
+		int32 End = 0x7E57;
+		Ar << End;
+		TestFalse(TEXT("Save error"), Ar.IsError());
+	}
+	
+	//~~~ Skip every blob ~~~
+	{
+		FMemoryReader Reader(Bytes, true);
+		FRamaSaveArchive Ar(Reader, true, nullptr);
+		for(int32 v = 0; v < (int32)ARRAY_COUNT(BlobSizes); v++)
+		{
+			Ar.Seek(Ar.LoadSizedEnd());
+		}
+		int32 End = 0;
+		Ar << End;
+		TestTrue(TEXT("Value after the skipped blobs"), End == 0x7E57);
+		TestFalse(TEXT("Skip error"), Ar.IsError());
+	}
+	
+	//~~~ Read the outer blobs, skip the inner ones ~~~
+	{
+		FMemoryReader Reader(Bytes, true);
+		FRamaSaveArchive Ar(Reader, true, nullptr);
+		for(int32 Size : BlobSizes)
+		{
+			const int64 OuterEnd = Ar.LoadSizedEnd();
+			int32 Marker = -1;
+			Ar << Marker;
+			TestTrue(TEXT("Outer blob value"), Marker == Size);
+			
+			const int64 InnerEnd = Ar.LoadSizedEnd();
+			TestTrue(TEXT("Inner blob size"), InnerEnd - Ar.Tell() == Size);
+			Ar.Seek(InnerEnd);
+			
+			//Rest of the outer blob, the string index
+			TestTrue(TEXT("Outer blob ends after its last value"), OuterEnd > Ar.Tell());
+			Ar.Seek(OuterEnd);
+		}
+		TestFalse(TEXT("Read error"), Ar.IsError());
+	}
+	return true;
+}
+
+/*
+	Property layouts: the ordinal path while the layout still fits the class (also after the class added properties the block does not have),
+	and property by property, skipping the values that no longer fit, after the class removed one or changed its type.
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRamaSaveLayoutTableTest, "RamaSaveSystem.Archive.LayoutTable", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRamaSaveLayoutTableTest::RunTest(const FString& Parameters)
+{
+	UProperty* Location = FindField<UProperty>(UChildActorComponent::StaticClass(), TEXT("RelativeLocation"));
+	UProperty* Scale = FindField<UProperty>(UChildActorComponent::StaticClass(), TEXT("RelativeScale3D"));
+	UProperty* Name = FindField<UProperty>(UChildActorComponent::StaticClass(), TEXT("AttachSocketName"));
+	UProperty* Tags = FindField<UProperty>(UChildActorComponent::StaticClass(), TEXT("ComponentTags"));
+	if(!TestNotNull(TEXT("RelativeLocation property"), Location) || !TestNotNull(TEXT("RelativeScale3D property"), Scale) || !TestNotNull(TEXT("AttachSocketName property"), Name) || !TestNotNull(TEXT("ComponentTags property"), Tags))
+	{
+		return false;
+	}
+	
+	UChildActorComponent* Source = NewObject<UChildActorComponent>();
+	*Location->ContainerPtrToValuePtr<FVector>(Source) = FVector(1.f, 2.f, 3.f);
+	*Scale->ContainerPtrToValuePtr<FVector>(Source) = FVector(4.f, 5.f, 6.f);
+	*Name->ContainerPtrToValuePtr<FName>(Source) = FName(TEXT("RamaSaveTestSocket"));
+	*Tags->ContainerPtrToValuePtr<TArray<FName>>(Source) = { FName(TEXT("RamaSaveTestTag")) };
+	
+	TArray<UProperty*> AllProperties = { Location, Scale, Name, Tags };
+	TArray<UProperty*> OlderProperties = { Location, Tags };
+	
+	//~~~ Save ~~~
+	TArray<uint8> RecordBytes;
+	TArray<uint8> StringBytes;
+	TArray<uint8> LayoutBytes;
+	{
+		FRamaSaveStringTable Strings;
+		FRamaSaveLayoutTable Layouts;
+		FMemoryWriter Writer(RecordBytes, true);
+		FRamaSaveArchive Ar(Writer, false, &Strings);
+		Ar.Layouts = &Layouts;
+		
+		//What the class saves now
+		URamaSaveComponent::SavePropertyBlockHeader(Ar, AllProperties);
+		for(UProperty* Property : AllProperties)
+		{
+			URamaSaveComponent::SaveProperty(Ar, Property, Source);
+		}
+		
+		//Saved before the class had Scale and Name
+		URamaSaveComponent::SavePropertyBlockHeader(Ar, OlderProperties);
+		for(UProperty* Property : OlderProperties)
+		{
+			URamaSaveComponent::SaveProperty(Ar, Property, Source);
+		}
+		
+		TestTrue(TEXT("Same properties, same layout"), Layouts.Add(Strings, AllProperties) == 0);
+		TestTrue(TEXT("Other properties, other layout"), Layouts.Add(Strings, OlderProperties) == 1);
+		
+		//Saved when the class still had a property it has since removed, and Scale was an FRotator
+		const uint32 ChangedIndex = Layouts.Layouts.Num();
+		FRamaSaveLayout& Changed = Layouts.Layouts[Layouts.Layouts.AddDefaulted()];
+		Changed.NameIndices = { Strings.Add(Location->GetFName()), Strings.Add(FString(TEXT("RamaSaveTestRemoved"))), Strings.Add(Scale->GetFName()), Strings.Add(Tags->GetFName()) };
+		Changed.TypeIndices = { Strings.Add(FRamaSaveLayoutTable::GetTypeName(Location)), Strings.Add(FString(TEXT("int32"))), Strings.Add(FString(TEXT("FRotator"))), Strings.Add(FRamaSaveLayoutTable::GetTypeName(Tags)) };
+		
+		uint32 LayoutIndex = ChangedIndex;
+		Ar.SerializeIntPacked(LayoutIndex);
+		URamaSaveComponent::SaveProperty(Ar, Location, Source);
+		Ar.SaveSized([&](FRamaSaveArchive& PropertyAr)
+		{
+			int32 RemovedValue = 42;
+			PropertyAr << RemovedValue;
+		});
+		Ar.SaveSized([&](FRamaSaveArchive& PropertyAr)
+		{
+			FRotator OldValue(7.f, 8.f, 9.f);
+			PropertyAr << OldValue;
+		});
+		URamaSaveComponent::SaveProperty(Ar, Tags, Source);
+		
+		TestFalse(TEXT("Save error"), Ar.IsError());
+		
+		FMemoryWriter StringsWriter(StringBytes, true);
+		StringsWriter << Strings;
+		FMemoryWriter LayoutsWriter(LayoutBytes, true);
+		LayoutsWriter << Layouts;
+	}
+	
+	//~~~ Load ~~~
+	FRamaSaveStringTable Strings;
+	FMemoryReader StringsReader(StringBytes, true);
+	StringsReader << Strings;
+	
+	FRamaSaveLayoutTable Layouts;
+	FMemoryReader LayoutsReader(LayoutBytes, true);
+	LayoutsReader << Layouts;
+	if(!TestTrue(TEXT("Layouts read"), Layouts.Layouts.Num() == 3 && Layouts.IsValid(Strings)))
+	{
+		return false;
+	}
+	
+	FMemoryReader Reader(RecordBytes, true);
+	FRamaSaveArchive Ar(Reader, true, &Strings);
+	Ar.Layouts = &Layouts;
+	
+	const FVector DefaultScale = *Scale->ContainerPtrToValuePtr<FVector>(GetMutableDefault<UChildActorComponent>());
+	AddExpectedError(TEXT("Property type changed since the file was saved"), EAutomationExpectedErrorFlags::Contains, 1);
+	
+	const bool bExpectMatch[] = { true, true, false };
+	for(int32 Block = 0; Block < 3; Block++)
+	{
+		int64 TotalProperties = 0;
+		const FRamaSaveLayout* Layout = URamaSaveComponent::LoadPropertyBlockHeader(Ar, TotalProperties);
+		if(!TestTrue(TEXT("Block layout"), Layout == &Layouts.Layouts[Block]))
+		{
+			return false;
+		}
+		
+		bool bMatches = false;
+		const TArray<UProperty*>& Resolved = Layouts.Resolve(Strings, *Layout, UChildActorComponent::StaticClass(), bMatches);
+		TestTrue(FString::Printf(TEXT("Block %d applied by ordinal"), Block), bMatches == bExpectMatch[Block]);
+		
+		UChildActorComponent* Dest = NewObject<UChildActorComponent>();
+		URamaSaveComponent::LoadPropertyBlock(Ar, Layout, TotalProperties, Dest);
+		
+		TestTrue(TEXT("Location"), *Location->ContainerPtrToValuePtr<FVector>(Dest) == FVector(1.f, 2.f, 3.f));
+		TestTrue(TEXT("Tags"), *Tags->ContainerPtrToValuePtr<TArray<FName>>(Dest) == *Tags->ContainerPtrToValuePtr<TArray<FName>>(Source));
+		if(Block == 0)
+		{
+			TestTrue(TEXT("Scale"), *Scale->ContainerPtrToValuePtr<FVector>(Dest) == FVector(4.f, 5.f, 6.f));
+			TestTrue(TEXT("Name"), *Name->ContainerPtrToValuePtr<FName>(Dest) == FName(TEXT("RamaSaveTestSocket")));
+		}
+		else
+		{
+			TestTrue(TEXT("Scale not in the block or changed type, left alone"), *Scale->ContainerPtrToValuePtr<FVector>(Dest) == DefaultScale);
+		}
+		
+		if(Block == 2)
+		{
+			TestTrue(TEXT("Removed property resolves to nothing"), Resolved.Num() == 4 && Resolved[1] == nullptr);
+			TestTrue(TEXT("Property of another type resolves to nothing"), Resolved.Num() == 4 && Resolved[2] == nullptr);
+		}
+	}
+	TestTrue(TEXT("Every block fully read"), Ar.Tell() == RecordBytes.Num());
+	TestFalse(TEXT("Load error"), Ar.IsError());
+	
+	//Out of range layout index
+	TArray<uint8> BadBytes;
+	FMemoryWriter BadWriter(BadBytes, true);
+	uint32 BadIndex = 9;
+	BadWriter.SerializeIntPacked(BadIndex);
+	FMemoryReader BadReader(BadBytes, true);
+	TestNull(TEXT("Layout index out of range"), Layouts.Load(BadReader));
+	TestTrue(TEXT("Layout index out of range is an error"), BadReader.IsError());
+	return true;
+}
+
+/*
+	Actor directory written and read back, then filtered by save tag and streaming level the way loads do,
+	including a record with more distinct tags than the mask holds.
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRamaSaveDirectoryFilterTest, "RamaSaveSystem.Archive.DirectoryFilter", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRamaSaveDirectoryFilterTest::RunTest(const FString& Parameters)
+{
+	const FString LevelA = TEXT("/Game/RamaSaveTest/LevelA");
+	const FString LevelB = TEXT("/Game/RamaSaveTest/LevelB");
+	
+	TArray<FString> ManyTags;
+	for(int32 v = 0; v < FRamaSaveActorDirectory::MaxTagBits + 10; v++)
+	{
+		ManyTags.Add(FString::Printf(TEXT("Many%d"), v));
+	}
+	
+	//~~~ Save ~~~
+	TArray<uint8> StringBytes;
+	TArray<uint8> DirectoryBytes;
+	{
+		FRamaSaveStringTable Strings;
+		FRamaSaveActorDirectory Directory;
+		Directory.Add(Strings, 100, TEXT("ClassA"), LevelA, FGuid(), { TEXT("Red"), TEXT("Blue") }, {});
+		Directory.Add(Strings, 200, TEXT("ClassB"), LevelB, FGuid(1, 2, 3, 4), { TEXT("Blue") }, { 5, 7 });
+		Directory.Add(Strings, 300, TEXT("ClassA"), LevelA, FGuid(), {}, {});
+		Directory.Add(Strings, 400, TEXT("ClassC"), LevelB, FGuid(), ManyTags, {});
+		
+		TestTrue(TEXT("Tag bits used up"), Directory.TagIndices.Num() == FRamaSaveActorDirectory::MaxTagBits);
+		TestTrue(TEXT("Record with too many tags overflows"), (Directory.Entries[3].TagMask & FRamaSaveActorDirectory::TagOverflow) != 0);
+		TestTrue(TEXT("Record with few tags does not"), (Directory.Entries[0].TagMask & FRamaSaveActorDirectory::TagOverflow) == 0);
+		
+		FMemoryWriter StringsWriter(StringBytes, true);
+		StringsWriter << Strings;
+		FMemoryWriter DirectoryWriter(DirectoryBytes, true);
+		DirectoryWriter << Directory;
+	}
+	
+	//~~~ Load ~~~
+	FRamaSaveStringTable Strings;
+	FMemoryReader StringsReader(StringBytes, true);
+	StringsReader << Strings;
+	
+	FRamaSaveActorDirectory Directory;
+	FMemoryReader DirectoryReader(DirectoryBytes, true);
+	DirectoryReader << Directory;
+	if(!TestTrue(TEXT("Directory read"), !DirectoryReader.IsError() && Directory.Entries.Num() == 4))
+	{
+		return false;
+	}
+	TestTrue(TEXT("Record position"), Directory.Entries[1].RecordBegin == 200);
+	TestTrue(TEXT("Record class"), Strings.Strings[Directory.Entries[1].ClassIndex] == TEXT("ClassB"));
+	TestTrue(TEXT("Record guid"), Directory.Entries[1].PersistentActorUniqueID == FGuid(1, 2, 3, 4));
+	TestTrue(TEXT("Record object references"), Directory.Entries[1].ObjectIndices == TArray<uint32>({ 5, 7 }));
+	
+	auto Find = [&](const TArray<FString>& WithTags, const FString& Level)
+	{
+		TArray<int32> Found;
+		Directory.FindCandidates(Strings, WithTags, Level, Found);
+		return Found;
+	};
+	
+	TestTrue(TEXT("No filter"), Find({}, TEXT("")) == TArray<int32>({ 0, 1, 2, 3 }));
+	TestTrue(TEXT("Old file level name is no filter"), Find({}, TEXT("Old File Version, Re-save this file to get level streaming info! <3 Rama")) == TArray<int32>({ 0, 1, 2, 3 }));
+	TestTrue(TEXT("Level"), Find({}, LevelB) == TArray<int32>({ 1, 3 }));
+	TestTrue(TEXT("Level nothing was saved in"), Find({}, TEXT("/Game/RamaSaveTest/LevelC")).Num() == 0);
+	
+	//Overflowed records are always candidates, their header decides
+	TestTrue(TEXT("Tag"), Find({ TEXT("Red") }, TEXT("")) == TArray<int32>({ 0, 3 }));
+	TestTrue(TEXT("Either tag"), Find({ TEXT("Red"), TEXT("Blue") }, TEXT("")) == TArray<int32>({ 0, 1, 3 }));
+	TestTrue(TEXT("Tag past the mask"), Find({ ManyTags.Last() }, TEXT("")) == TArray<int32>({ 3 }));
+	TestTrue(TEXT("Tag nothing has"), Find({ TEXT("Green") }, TEXT("")) == TArray<int32>({ 3 }));
+	TestTrue(TEXT("Tag and level"), Find({ TEXT("Blue") }, LevelA) == TArray<int32>({ 0 }));
+	return true;
+}
+
+/*
+	Parallel Save: a chunk written with a table of its own, string indices fixed width inside nested sized blobs,
+	then remapped in place to a table that already has other strings, and read back with that table.
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRamaSaveChunkRemapTest, "RamaSaveSystem.Archive.ChunkRemap", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRamaSaveChunkRemapTest::RunTest(const FString& Parameters)
+{
+	//~~~ Chunk ~~~
+	TArray<uint8> Chunk;
+	FRamaSaveStringTable ChunkStrings;
+	TArray<int64> Fixups;
+	{
+		FMemoryWriter Writer(Chunk, true);
+		FRamaSaveArchive Ar(Writer, false, &ChunkStrings);
+		Ar.StringFixups = &Fixups;
+		
+		FString First = TEXT("RamaSaveTestFirst");
+		Ar.SerializeString(First);
+		Ar.SaveSized([&](FRamaSaveArchive& OuterAr)
+		{
+			FName Name(TEXT("RamaSaveTestName"));
+			OuterAr << Name;
+			OuterAr.SaveSized([&](FRamaSaveArchive& InnerAr)
+			{
+				UObject* Object = AActor::StaticClass();
+				InnerAr << Object;
+				FString Again = TEXT("RamaSaveTestFirst");
+				InnerAr.SerializeString(Again);
+			});
+		});
+	}
+	TestTrue(TEXT("Every string index has a fixup"), Fixups.Num() == 4);
+	
+	//~~~ Merged into a table that already has entries, so every index moves ~~~
+	FRamaSaveStringTable Strings;
+	for(int32 v = 0; v < 200; v++)
+	{
+		Strings.Add(FString::Printf(TEXT("RamaSaveTestEarlier%d"), v));
+	}
+	TArray<uint32> Remap;
+	for(const FString& Each : ChunkStrings.Strings)
+	{
+		Remap.Add(Strings.Add(Each));
+	}
+	for(int64 Each : Fixups)
+	{
+		FRamaSaveArchive::RemapStringIndex(Chunk.GetData() + Each, Remap);
+	}
+	
+	TArray<uint8> StringBytes;
+	FMemoryWriter StringsWriter(StringBytes, true);
+	StringsWriter << Strings;
+	
+	//~~~ Load ~~~
+	FRamaSaveStringTable Loaded;
+	FMemoryReader StringsReader(StringBytes, true);
+	StringsReader << Loaded;
+	
+	FMemoryReader Reader(Chunk, true);
+	FRamaSaveArchive Ar(Reader, true, &Loaded);
+	
+	FString First;
+	Ar.SerializeString(First);
+	TestTrue(TEXT("String"), First == TEXT("RamaSaveTestFirst"));
+	
+	const int64 OuterEnd = Ar.LoadSizedEnd();
+	FName Name;
+	Ar << Name;
+	TestTrue(TEXT("FName in a sized blob"), Name == FName(TEXT("RamaSaveTestName")));
+	
+	const int64 InnerEnd = Ar.LoadSizedEnd();
+	UObject* Object = nullptr;
+	Ar << Object;
+	TestTrue(TEXT("Object in a nested sized blob"), Object == AActor::StaticClass());
+	FString Again;
+	Ar.SerializeString(Again);
+	TestTrue(TEXT("Repeated string"), Again == TEXT("RamaSaveTestFirst"));
+	
+	TestTrue(TEXT("Blobs fully read"), Ar.Tell() == InnerEnd && InnerEnd == OuterEnd && OuterEnd == Chunk.Num());
+	TestFalse(TEXT("Load error"), Ar.IsError());
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -0,0 +1,167 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#include "RamaSaveSystemPrivatePCH.h"
+#include "RamaSaveBlockArchive.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace RamaSaveBlockArchiveTests
+{
+	//Compressible bytes first, then noise so some blocks are stored raw
+	void MakeTestData(int64 Size, TArray<uint8>& OutData)
+	{
+		FRandomStream Random(0x52534246);
+		OutData.SetNumUninitialized((int32)Size);
+		for(int32 v = 0; v < OutData.Num(); v++)
+		{
+			OutData[v] = (v < OutData.Num() / 2) ? (uint8)((v / 64) % 7) : (uint8)Random.RandHelper(256);
+		}
+	}
+	
+	//Block file of Data, after Prefix bytes of something else, the way a section sits in a bigger file
+	bool WriteBlockFile(const TArray<uint8>& Data, ERamaSaveCodec Codec, int32 Prefix, TArray<uint8>& OutFile)
+	{
+		FMemoryWriter FileWriter(OutFile, true);
+		for(int32 v = 0; v < Prefix; v++)
+		{
+			uint8 Filler = 0xEE;
+			FileWriter << Filler;
+		}
+		
+		FRamaSaveBlockWriter Writer(&FileWriter, false, Codec);
+		
+		//Uneven writes, so blocks are filled across several calls
+		const int32 Step = RamaSaveBlockFile::BlockSize / 3 + 17;
+		for(int32 Offset = 0; Offset < Data.Num(); Offset += Step)
+		{
+			Writer.Serialize((void*)(Data.GetData() + Offset), FMath::Min(Step, Data.Num() - Offset));
+		}
+		return Writer.Close();
+	}
+}
+
+/*
+	Block framed files written and read back with every codec, 
+	whole and through a window of one block, with seeks back and forth across block boundaries.
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRamaSaveBlockRoundTripTest, "RamaSaveSystem.BlockArchive.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRamaSaveBlockRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace RamaSaveBlockArchiveTests;
+	
+	const int32 BlockSize = RamaSaveBlockFile::BlockSize;
+	TArray<uint8> Data;
+	MakeTestData(BlockSize * 3 + BlockSize / 2, Data);
+	
+	const ERamaSaveCodec Codecs[] = { ERamaSaveCodec::None, ERamaSaveCodec::Zlib, ERamaSaveCodec::Fast, ERamaSaveCodec::HighRatio };
+	for(ERamaSaveCodec Codec : Codecs)
+	{
+		const FString CodecName = FString::FromInt((int32)Codec);
+		const int32 Prefix = 13;
+		
+		TArray<uint8> File;
+		if(!TestTrue(TEXT("Block file written, codec ") + CodecName, WriteBlockFile(Data, Codec, Prefix, File)))
+		{
+			continue;
+		}
+		
+		//~~~ Header ~~~
+		FMemoryReader FileReader(File, true);
+		FRamaSaveRangeReader Range(&FileReader, false, Prefix, File.Num() - Prefix);
+		FRamaSaveBlockHeader Header;
+		if(!TestTrue(TEXT("Header read, codec ") + CodecName, Header.Read(Range)))
+		{
+			continue;
+		}
+		TestTrue(TEXT("Codec"), Header.Codec == Codec);
+		TestTrue(TEXT("Uncompressed size"), Header.UncompressedSize == Data.Num());
+		TestTrue(TEXT("Block count"), Header.NumBlocks == 4);
+		TestTrue(TEXT("Noise block is stored raw"), Header.IsStoredRaw(3));
+		if(Codec != ERamaSaveCodec::None)
+		{
+			TestFalse(TEXT("Repeating block is compressed"), Header.IsStoredRaw(0));
+		}
+		
+		//~~~ Whole ~~~
+		{
+			FRamaSaveBlockReader Reader(new FRamaSaveRangeReader(&FileReader, false, Prefix, File.Num() - Prefix), true);
+			TArray<uint8> Read;
+			Read.SetNumUninitialized(Data.Num());
+			Reader.Serialize(Read.GetData(), Read.Num());
+			TestFalse(TEXT("Reader error, codec ") + CodecName, Reader.IsError());
+			TestTrue(TEXT("Whole file matches, codec ") + CodecName, Read == Data);
+		}
+		
+		//~~~ One block at a time, seeking ~~~
+		{
+			FRamaSaveBlockReader Reader(new FRamaSaveRangeReader(&FileReader, false, Prefix, File.Num() - Prefix), true, 1);
+			const int64 Positions[] = { BlockSize * 3 + 5, BlockSize - 100, 0, BlockSize * 2 - 1 };
+			for(int64 Pos : Positions)
+			{
+				uint8 Read[200];
+				const int32 Count = (int32)FMath::Min<int64>(sizeof(Read), Data.Num() - Pos);
+				Reader.Seek(Pos);
+				Reader.Serialize(Read, Count);
+				TestTrue(TEXT("Range across blocks matches, codec ") + CodecName, FMemory::Memcmp(Read, Data.GetData() + Pos, Count) == 0);
+			}
+			TestFalse(TEXT("Seeking reader error"), Reader.IsError());
+			
+			//Past the end is an error, not a crash
+			uint8 Past = 0;
+			Reader.Seek(Data.Num());
+			Reader.Serialize(&Past, 1);
+			TestTrue(TEXT("Reading past the end is an error"), Reader.IsError());
+		}
+	}
+	
+	//~~~ Whole buffer helpers, used for the small sections ~~~
+	TArray<uint8> Compressed;
+	TArray<uint8> Decompressed;
+	TestTrue(TEXT("CompressBlocks"), URamaSaveUtility::CompressBlocks(Data, Compressed, ERamaSaveCodec::Zlib));
+	TestTrue(TEXT("Compressed buffer is block framed"), URamaSaveUtility::IsBlockFramed(Compressed));
+	TestTrue(TEXT("DecompressBlocks"), URamaSaveUtility::DecompressBlocks(Compressed, Decompressed));
+	TestTrue(TEXT("Whole buffer matches"), Decompressed == Data);
+	return true;
+}
+
+/*
+	More data than the writer's window, so blocks are compressed and written out in several windows
+	before the block table, and the reader's windows do not line up with the writer's.
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRamaSaveBlockWindowsTest, "RamaSaveSystem.BlockArchive.Windows", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRamaSaveBlockWindowsTest::RunTest(const FString& Parameters)
+{
+	using namespace RamaSaveBlockArchiveTests;
+	
+	const int32 BlockSize = RamaSaveBlockFile::BlockSize;
+	const int32 WindowBlocks = RamaSaveBlockFile::GetWindowBlocks();
+	
+	TArray<uint8> Data;
+	MakeTestData((int64)(WindowBlocks * 2 + 1) * BlockSize + 1234, Data);
+	
+	TArray<uint8> File;
+	if(!TestTrue(TEXT("Block file written"), WriteBlockFile(Data, ERamaSaveCodec::Fast, 0, File)))
+	{
+		return false;
+	}
+	
+	FMemoryReader FileReader(File, true);
+	FRamaSaveBlockReader Reader(&FileReader, false, 3);
+	if(!TestTrue(TEXT("Header read"), Reader.IsValid()))
+	{
+		return false;
+	}
+	TestTrue(TEXT("Total size"), Reader.TotalSize() == Data.Num());
+	
+	TArray<uint8> Read;
+	Read.SetNumUninitialized(Data.Num());
+	Reader.Serialize(Read.GetData(), Read.Num());
+	TestFalse(TEXT("Reader error"), Reader.IsError());
+	TestTrue(TEXT("Data matches"), Read == Data);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
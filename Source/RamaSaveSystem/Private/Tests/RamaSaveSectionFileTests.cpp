@@ -0,0 +1,233 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#include "RamaSaveSystemPrivatePCH.h"
+#include "RamaSaveSectionFile.h"
+#include "RamaSaveEngine.h"
+#include "RamaSaveLibrary.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace RamaSaveSectionFileTests
+{
+	FString GetTestFile(const TCHAR* Name)
+	{
+		return FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("RamaSaveSystem") / Name);
+	}
+	
+	void MakeTestData(int32 Size, uint8 Seed, TArray<uint8>& OutData)
+	{
+		OutData.SetNumUninitialized(Size);
+		for(int32 v = 0; v < Size; v++)
+		{
+			OutData[v] = (uint8)(Seed + v * 31 + v / 1000);
+		}
+	}
+	
+	//Header with the given save version, a streamed actor section and a small table section
+	bool WriteTestFile(const FString& FileName, int32 SaveVersion, const TArray<uint8>& Actors, const TArray<uint8>& Strings, ERamaSaveCodec Codec)
+	{
+		if(!URamaSaveUtility::CreateDirectoryTreeForFile(FileName))
+		{
+			return false;
+		}
+		TUniquePtr<FRamaSaveSectionWriter> Writer(FRamaSaveSectionWriter::CreateFile(FileName));
+		if(!Writer.IsValid())
+		{
+			return false;
+		}
+		
+		TArray<uint8> Header;
+		FMemoryWriter HeaderWriter(Header, true);
+		HeaderWriter << SaveVersion;
+		Writer->WriteSection(RamaSaveSectionFile::Header, Header, Codec);
+		
+		FArchive& ActorsAr = Writer->BeginSection(RamaSaveSectionFile::Actors, Codec);
+		for(int32 Offset = 0; Offset < Actors.Num(); Offset += 4096)
+		{
+			ActorsAr.Serialize(const_cast<uint8*>(Actors.GetData() + Offset), FMath::Min(4096, Actors.Num() - Offset));
+		}
+		Writer->EndSection();
+		
+		Writer->WriteSection(RamaSaveSectionFile::Strings, Strings, Codec);
+		return Writer->Close();
+	}
+}
+
+/*
+	Sections written one after the other (one of them streamed), then found through the section table 
+	and read back whole, streamed a window at a time, and memory mapped when stored uncompressed.
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRamaSaveSectionRoundTripTest, "RamaSaveSystem.SectionFile.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRamaSaveSectionRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace RamaSaveSectionFileTests;
+	
+	TArray<uint8> Actors;
+	TArray<uint8> Strings;
+	MakeTestData(RamaSaveBlockFile::BlockSize * 2 + 777, 1, Actors);
+	MakeTestData(333, 2, Strings);
+	
+	const ERamaSaveCodec Codecs[] = { ERamaSaveCodec::None, ERamaSaveCodec::Zlib };
+	for(ERamaSaveCodec Codec : Codecs)
+	{
+		const FString FileName = GetTestFile(*FString::Printf(TEXT("SectionRoundTrip%d.sav"), (int32)Codec));
+		if(!TestTrue(TEXT("File written"), WriteTestFile(FileName, JOY_SAVE_VERSION, Actors, Strings, Codec)))
+		{
+			continue;
+		}
+		
+		TUniquePtr<FRamaSaveSectionReader> Reader(FRamaSaveSectionReader::OpenFile(FileName));
+		if(!TestTrue(TEXT("Section table read"), Reader.IsValid()))
+		{
+			continue;
+		}
+		
+		//~~~ Table ~~~
+		const FRamaSaveSectionEntry* ActorsEntry = Reader->FindSection(RamaSaveSectionFile::Actors);
+		if(TestNotNull(TEXT("Actor section"), ActorsEntry))
+		{
+			TestTrue(TEXT("Actor section raw size"), ActorsEntry->RawSize == Actors.Num());
+			TestTrue(TEXT("Actor section codec"), ActorsEntry->Codec == (uint8)Codec);
+		}
+		TestNull(TEXT("Section that was not written"), Reader->FindSection(RamaSaveSectionFile::Directory));
+		
+		TArray<uint8> Missing;
+		TestFalse(TEXT("Reading a section that was not written"), Reader->ReadSection(RamaSaveSectionFile::Layouts, Missing));
+		
+		//~~~ Whole ~~~
+		TArray<uint8> Read;
+		TestTrue(TEXT("Small section read"), Reader->ReadSection(RamaSaveSectionFile::Strings, Read));
+		TestTrue(TEXT("Small section matches"), Read == Strings);
+		
+		//~~~ Big section, streamed and not ~~~
+		const bool bAllowStreaming[] = { true, false };
+		for(bool bStreaming : bAllowStreaming)
+		{
+			TArray<uint8> Buffer;
+			TUniquePtr<FArchive> SectionAr(Reader->OpenSection(RamaSaveSectionFile::Actors, bStreaming, Buffer));
+			if(!TestTrue(TEXT("Actor section opened"), SectionAr.IsValid()))
+			{
+				continue;
+			}
+			TestTrue(TEXT("Actor section size"), SectionAr->TotalSize() == Actors.Num());
+			
+			//Second half first, the way filtered loads jump to a record
+			TArray<uint8> Section;
+			Section.SetNumUninitialized(Actors.Num());
+			const int32 Half = Actors.Num() / 2;
+			SectionAr->Seek(Half);
+			SectionAr->Serialize(Section.GetData() + Half, Section.Num() - Half);
+			SectionAr->Seek(0);
+			SectionAr->Serialize(Section.GetData(), Half);
+			
+			TestFalse(TEXT("Actor section error"), SectionAr->IsError());
+			TestTrue(TEXT("Actor section matches"), Section == Actors);
+		}
+		
+		Reader.Reset();
+		TestTrue(TEXT("Save file header is accepted"), URamaSaveLibrary::CheckSaveFileHeader(FileName));
+		IFileManager::Get().Delete(*FileName);
+	}
+	return true;
+}
+
+/*
+	Files whose section table can not be trusted are refused before any section is read:
+	not sectioned, from a newer version, sections past the end of the file, or truncated.
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRamaSaveSectionTableValidationTest, "RamaSaveSystem.SectionFile.TableValidation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRamaSaveSectionTableValidationTest::RunTest(const FString& Parameters)
+{
+	using namespace RamaSaveSectionFileTests;
+	
+	const FString FileName = GetTestFile(TEXT("SectionValidation.sav"));
+	auto WriteHeader = [](TArray<uint8>& Bytes, uint32 Magic, uint32 Version, int32 NumSections)
+	{
+		FMemoryWriter Writer(Bytes, true);
+		Writer << Magic;
+		Writer << Version;
+		Writer << NumSections;
+	};
+	
+	//Older files are not an error, they are read the old way
+	{
+		TArray<uint8> Bytes;
+		WriteHeader(Bytes, RamaSaveBlockFile::Magic, 3, 0);
+		FFileHelper::SaveArrayToFile(Bytes, *FileName);
+		TUniquePtr<FRamaSaveSectionReader> Reader(FRamaSaveSectionReader::OpenFile(FileName));
+		TestFalse(TEXT("Not a sectioned file"), Reader.IsValid());
+	}
+	
+	AddExpectedError(TEXT("Section table is not valid or from a newer version"), EAutomationExpectedErrorFlags::Contains, 2);
+	{
+		TArray<uint8> Bytes;
+		WriteHeader(Bytes, RamaSaveSectionFile::Magic, RamaSaveSectionFile::Version + 1, 0);
+		FFileHelper::SaveArrayToFile(Bytes, *FileName);
+		TUniquePtr<FRamaSaveSectionReader> Reader(FRamaSaveSectionReader::OpenFile(FileName));
+		TestFalse(TEXT("Newer section version"), Reader.IsValid());
+	}
+	{
+		TArray<uint8> Bytes;
+		WriteHeader(Bytes, RamaSaveSectionFile::Magic, RamaSaveSectionFile::Version, 100000);
+		FFileHelper::SaveArrayToFile(Bytes, *FileName);
+		TUniquePtr<FRamaSaveSectionReader> Reader(FRamaSaveSectionReader::OpenFile(FileName));
+		TestFalse(TEXT("Section count out of range"), Reader.IsValid());
+	}
+	
+	AddExpectedError(TEXT("Section table is corrupt"), EAutomationExpectedErrorFlags::Contains, 2);
+	{
+		TArray<uint8> Bytes;
+		WriteHeader(Bytes, RamaSaveSectionFile::Magic, RamaSaveSectionFile::Version, 1);
+		
+		FRamaSaveSectionEntry Entry;
+		Entry.Id = RamaSaveSectionFile::Actors;
+		Entry.Offset = 1000;
+		Entry.StoredSize = 50;
+		Entry.RawSize = 50;
+		FMemoryWriter Writer(Bytes, true);
+		Writer.Seek(Bytes.Num());
+		Writer << Entry;
+		
+		FFileHelper::SaveArrayToFile(Bytes, *FileName);
+		TUniquePtr<FRamaSaveSectionReader> Reader(FRamaSaveSectionReader::OpenFile(FileName));
+		TestFalse(TEXT("Section past the end of the file"), Reader.IsValid());
+	}
+	{
+		//A real file cut short, its table points past what is left
+		TArray<uint8> Actors;
+		TArray<uint8> Strings;
+		MakeTestData(100000, 3, Actors);
+		MakeTestData(100, 4, Strings);
+		if(TestTrue(TEXT("File written"), WriteTestFile(FileName, JOY_SAVE_VERSION, Actors, Strings, ERamaSaveCodec::None)))
+		{
+			TArray<uint8> Bytes;
+			FFileHelper::LoadFileToArray(Bytes, *FileName);
+			Bytes.SetNum(Bytes.Num() / 2);
+			FFileHelper::SaveArrayToFile(Bytes, *FileName);
+			
+			TUniquePtr<FRamaSaveSectionReader> Reader(FRamaSaveSectionReader::OpenFile(FileName));
+			TestFalse(TEXT("Truncated file"), Reader.IsValid());
+		}
+	}
+	
+	//Valid table, but a save version this build can not read
+	AddExpectedError(TEXT("File is from a newer Rama Save System version"), EAutomationExpectedErrorFlags::Contains, 1);
+	{
+		TArray<uint8> Actors;
+		TArray<uint8> Strings;
+		MakeTestData(100, 5, Actors);
+		MakeTestData(100, 6, Strings);
+		if(TestTrue(TEXT("File written"), WriteTestFile(FileName, JOY_SAVE_VERSION + 1, Actors, Strings, ERamaSaveCodec::Zlib)))
+		{
+			TestFalse(TEXT("Newer save version"), URamaSaveLibrary::CheckSaveFileHeader(FileName));
+		}
+	}
+	
+	IFileManager::Get().Delete(*FileName);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
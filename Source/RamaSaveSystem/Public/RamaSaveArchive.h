@@ -0,0 +1,286 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ObjectAndNameAsStringProxyArchive.h"
+#include "MemoryWriter.h"
+#include "Containers/ArrayView.h"
+#include "UObject/WeakObjectPtr.h"
+#include "UObject/ObjectKey.h"
+
+class UProperty;
+
+/*
+	Strings that repeat across actor records (class names, class paths, level package names,
+	component and property names), written once per file (JOY_SAVE_VERSION_STRINGTABLE+).
+	
+	Object references and FNames inside property values use it too (JOY_SAVE_VERSION_OBJECTTABLE+),
+	so an asset referenced by thousands of actors is one path in the file, looked up once when loading.
+	
+	Records refer to entries by a packed int index.
+*/
+struct FRamaSaveStringTable
+{
+	TArray<FString> Strings;
+	
+	//Loading, one per entry so property lookups skip the string to FName conversion
+	TArray<FName> Names;
+	
+	//Saving
+	uint32 Add(const FString& Value);
+	uint32 Add(FName Value);
+	uint32 Add(UObject* Object);
+	
+	//Loading, the object at the path of this entry, found (or loaded) the first time it is asked for
+	UObject* FindObject(uint32 Index, bool bLoadIfFindFails);
+	
+	void Reset();
+	
+	//Saving off the game thread, paths resolved when the values were copied, objects are only looked up by address
+	const TMap<UObject*, FString>* ObjectPaths = nullptr;
+	
+	//Objects that were not in ObjectPaths and were written as null
+	int32 MissingObjectPaths = 0;
+	
+	friend FArchive& operator<<(FArchive& Ar, FRamaSaveStringTable& Table);
+	
+private:
+	//Case sensitive, class paths are stored exactly as they were given
+	struct FStringKeyFuncs : TDefaultMapKeyFuncs<FString, uint32, false>
+	{
+		static FORCEINLINE bool Matches(const FString& A, const FString& B)
+		{
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+		static FORCEINLINE uint32 GetKeyHash(const FString& Key)
+		{
+			return FCrc::StrCrc32(*Key);
+		}
+	};
+	TMap<FString, uint32, FDefaultSetAllocator, FStringKeyFuncs> StringIndices;
+	TMap<FName, uint32> NameIndices;
+	
+	//Saving, so GetPathName runs once per object
+	TMap<FObjectKey, uint32> ObjectIndices;
+	
+	//Loading, weak so a reference that was garbage collected between frames is looked up again
+	TMap<uint32, TWeakObjectPtr<UObject>> Objects;
+};
+
+/** Where one actor record is and what the load filters need to know about it */
+struct FRamaSaveDirectoryEntry
+{
+	int64 RecordBegin = 0;
+	uint32 ClassIndex = 0;
+	uint32 LevelIndex = 0;
+	FGuid PersistentActorUniqueID;
+	uint64 TagMask = 0;
+	
+	//String table entries of the objects the record's values reference, what a load of this record preloads (JOY_SAVE_VERSION_OBJECTREFS+)
+	TArray<uint32> ObjectIndices;
+	
+	friend FArchive& operator<<(FArchive& Ar, FRamaSaveDirectoryEntry& Entry)
+	{
+		Ar << Entry.RecordBegin;
+		Ar.SerializeIntPacked(Entry.ClassIndex);
+		Ar.SerializeIntPacked(Entry.LevelIndex);
+		Ar << Entry.PersistentActorUniqueID;
+		Ar << Entry.TagMask;
+		return Ar;
+	}
+};
+
+/*
+	One entry per actor record (JOY_SAVE_VERSION_DIRECTORY+), 
+	so a filtered load only reads the records that can match instead of every header in order.
+	
+	Bit N of a TagMask is the tag at TagIndices[N] in the string table.
+	Records with more distinct tags than fit set TagOverflow and are always checked against their header.
+*/
+struct FRamaSaveActorDirectory
+{
+	static const int32 MaxTagBits = 63;
+	static const uint64 TagOverflow = 1ull << 63;
+	
+	TArray<uint32> TagIndices;
+	TArray<FRamaSaveDirectoryEntry> Entries;
+	
+	//Loading, whether the file has the object references of each entry, saving always does
+	bool bObjectReferences = true;
+	
+	//Saving
+	void Add(FRamaSaveStringTable& Strings, int64 RecordBegin, const FString& ActorClass, const FString& LevelPackageName, const FGuid& PersistentActorUniqueID, const TArray<FString>& SaveTags, const TArray<uint32>& ObjectIndices);
+	
+	void Reset();
+	
+	//Loading, same filters as URamaSaveComponent::ShouldLoadActorRecord
+	void FindCandidates(const FRamaSaveStringTable& Strings, const TArray<FString>& LoadActorsWithSaveTags, const FString& LoadOnlyStreamingLevel, TArray<int32>& OutEntries) const;
+	
+	friend FArchive& operator<<(FArchive& Ar, FRamaSaveActorDirectory& Directory)
+	{
+		Ar << Directory.TagIndices;
+		Ar << Directory.Entries;
+		
+		//After the entries so older directories read the same
+		if(Directory.bObjectReferences)
+		{
+			for(FRamaSaveDirectoryEntry& Each : Directory.Entries)
+			{
+				Ar << Each.ObjectIndices;
+			}
+		}
+		return Ar;
+	}
+	
+private:
+	TMap<uint32, int32> TagBits;
+};
+
+/** Names and types of one block of properties in the order they are written, indices into the string table */
+struct FRamaSaveLayout
+{
+	uint32 Hash = 0;
+	TArray<uint32> NameIndices;
+	TArray<uint32> TypeIndices;
+	
+	friend FArchive& operator<<(FArchive& Ar, FRamaSaveLayout& Layout)
+	{
+		Ar << Layout.Hash;
+		Ar << Layout.NameIndices;
+		Ar << Layout.TypeIndices;
+		return Ar;
+	}
+};
+
+/*
+	Property layouts (JOY_SAVE_VERSION_LAYOUTS+), shared by every block that wrote the same properties.
+	
+	A property block starts with its layout index instead of a count, and each property is only its sized value.
+	
+	Loading resolves a layout against a class once per file. When the hash of the class's current names and types
+	matches, the block is applied by ordinal, otherwise property by property, skipping the ones that no longer fit.
+*/
+struct FRamaSaveLayoutTable
+{
+	TArray<FRamaSaveLayout> Layouts;
+	
+	//Saving
+	uint32 Add(FRamaSaveStringTable& Strings, TArrayView<UProperty* const> Properties);
+	
+	//Loading, reads a block's layout index, nullptr if it is not in the table
+	const FRamaSaveLayout* Load(FArchive& Ar) const;
+	
+	//Loading, the property for each ordinal of the layout in Class (nullptr where it is gone or changed type), 
+	//	bMatches when the whole layout still fits and the block can be applied by ordinal
+	const TArray<UProperty*>& Resolve(const FRamaSaveStringTable& Strings, const FRamaSaveLayout& Layout, UClass* Class, bool& bMatches);
+	
+	//Loading, every index in range
+	bool IsValid(const FRamaSaveStringTable& Strings) const;
+	
+	void Reset();
+	
+	static FString GetTypeName(UProperty* Property);
+	
+	friend FArchive& operator<<(FArchive& Ar, FRamaSaveLayoutTable& Table)
+	{
+		Ar << Table.Layouts;
+		return Ar;
+	}
+	
+private:
+	static uint32 HashEntry(const FString& Name, const FString& Type, uint32 Hash);
+	
+	//Saving, layout indices by the hash of the property pointers
+	TMultiMap<uint32, uint32> LayoutsByProperties;
+	TArray<TArray<UProperty*>> LayoutProperties;
+	
+	//Loading, per class and layout, held by pointer so returned arrays stay put
+	struct FResolved
+	{
+		TArray<UProperty*> Properties;
+		bool bMatches = false;
+	};
+	TMap<TPair<TWeakObjectPtr<UClass>, const FRamaSaveLayout*>, TUniquePtr<FResolved>> Resolved;
+};
+
+/*
+	Archive that actor records are saved and loaded through.
+	
+	With a string table, SerializeString/SerializeName write a table index,
+	without one (files older than the table) they are plain FStrings.
+	
+	Sized blobs (JOY_SAVE_VERSION_SIZEDRECORDS+) are a packed size followed by the bytes,
+	written in one forward pass from a scratch buffer instead of seeking back to patch an int64 end position.
+*/
+class FRamaSaveArchive : public FObjectAndNameAsStringProxyArchive
+{
+public:
+	FRamaSaveArchive(FArchive& InInnerArchive, bool bInLoadIfFindFails, FRamaSaveStringTable* InStrings)
+		: FObjectAndNameAsStringProxyArchive(InInnerArchive, bInLoadIfFindFails)
+		, Strings(InStrings)
+	{
+	}
+	
+	void SerializeString(FString& Value);
+	void SerializeName(FName& Value);
+	
+	//Saving, Body writes the blob into the archive it is given
+	template<typename FunctorType>
+	void SaveSized(FunctorType&& Body)
+	{
+		FRamaSaveArchive& Nested = BeginSized();
+		Body(Nested);
+		EndSized();
+	}
+	
+	//Loading, reads the size and returns where the blob ends, the blob itself is read from this archive
+	int64 LoadSizedEnd();
+	
+	virtual FString GetArchiveName() const override { return TEXT("FRamaSaveArchive"); }
+	
+	FRamaSaveStringTable* Strings;
+	
+	//Saving, records add themselves when set
+	FRamaSaveActorDirectory* Directory = nullptr;
+	
+	//Saving always has one, loading only for files that have one
+	FRamaSaveLayoutTable* Layouts = nullptr;
+	
+	//Loading, whether the file uses sized blobs, saving always does
+	bool bSizedRecords = true;
+	
+	//Loading, whether the file stores plain old data as raw bytes, saving always does
+	bool bRawValues = true;
+	
+	//Loading, whether object references and FNames in property values are string table indices, saving always does
+	bool bReferenceTable = true;
+	
+	//Saving, collects the string table entry of each object reference written while set, once each
+	TArray<uint32>* ObjectReferences = nullptr;
+	
+	//Saving with a table of its own (Parallel Save), string indices are written FixedIndexBytes wide and their offsets collected here in order,
+	//	so the buffer can be appended to the file once RemapStringIndex has put in the indices of the file's table
+	TArray<int64>* StringFixups = nullptr;
+	
+	static const int32 FixedIndexBytes = 4;
+	static void RemapStringIndex(uint8* Index, const TArray<uint32>& Remap);
+	
+	//Property values, through the string table when there is one
+	using FObjectAndNameAsStringProxyArchive::operator<<;
+	virtual FArchive& operator<<(FName& Value) override;
+	virtual FArchive& operator<<(UObject*& Value) override;
+	
+private:
+	FRamaSaveArchive& BeginSized();
+	void EndSized();
+	
+	//Saving, packed, or FixedIndexBytes wide with StringFixups
+	void SaveStringIndex(uint32 Index);
+	
+	//One scratch buffer per nesting depth, reused by every blob at that depth
+	TArray<uint8> Scratch;
+	TArray<int64> ScratchFixups;
+	TUniquePtr<FMemoryWriter> ScratchWriter;
+	TUniquePtr<FRamaSaveArchive> ScratchArchive;
+	bool bInSized = false;
+};
\ No newline at end of file
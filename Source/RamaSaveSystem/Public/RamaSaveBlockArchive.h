@@ -0,0 +1,244 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#pragma once
+
+#include "RamaSaveUtility.h"
+#include "BufferReader.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/*
+	Block Framed File Layout
+
+	uint32 	Magic
+	uint32 	Version
+	uint8 	Codec 				(Version 2+, ERamaSaveCodec, Version 1 files are always Zlib)
+	int32 	BlockSize
+	int64 	UncompressedSize
+	int32 	NumBlocks
+	int64 	BlockTableOffset 	(Version 3+)
+
+	Version 1-2: 	int32 StoredSize[NumBlocks] right after the header, then the blocks
+	Version 3+: 	the blocks right after the header, block table at BlockTableOffset at the end of the file,
+					so a file can be written before its total size is known
+
+	Every block is its own stream of BlockSize uncompressed bytes (last one may be shorter).
+	Version 2+: a block whose StoredSize equals its uncompressed size is stored raw,
+	this is how incompressible blocks and the None codec are written.
+*/
+namespace RamaSaveBlockFile
+{
+	const uint32 Magic = 0x46425352;	//"RSBF", old single stream files start with PACKAGE_FILE_TAG instead
+	const uint32 Version = 3;
+	const uint32 Version_Codec = 2;
+	const uint32 Version_TableAtEnd = 3;
+	const int32 BlockSize = 1024 * 1024;
+
+	//Returns false if the block should be stored raw instead
+	bool CompressBlock(ERamaSaveCodec Codec, const uint8* Raw, int32 RawSize, TArray<uint8>& Block);
+	bool DecompressBlock(bool bStoredRaw, uint8* Raw, int32 RawSize, const uint8* Stored, int32 StoredSize);
+
+	//How many blocks fit in the Streaming Window Size from the project settings
+	int32 GetWindowBlocks();
+}
+
+/** Header and block table of a block framed file */
+struct FRamaSaveBlockHeader
+{
+	uint32 Version = 0;
+	ERamaSaveCodec Codec = ERamaSaveCodec::Zlib;
+	int32 BlockSize = 0;
+	int64 UncompressedSize = 0;
+	int32 NumBlocks = 0;
+
+	TArray<int32> StoredSizes;
+	TArray<int64> FileOffsets;
+
+	//Archive must be seekable, position afterwards is unspecified
+	bool Read(FArchive& Ar);
+
+	FORCEINLINE int32 GetRawSize(int32 BlockIndex) const
+	{
+		return (int32)FMath::Min<int64>(BlockSize, UncompressedSize - (int64)BlockIndex * BlockSize);
+	}
+	FORCEINLINE bool IsStoredRaw(int32 BlockIndex) const
+	{
+		return Version >= RamaSaveBlockFile::Version_Codec && StoredSizes[BlockIndex] == GetRawSize(BlockIndex);
+	}
+};
+
+/*
+	Writes a block framed file as data comes in.
+
+	Bytes are gathered into a window of blocks, compressed on the task graph and written out
+	once the window is full, so memory use does not depend on how much is written.
+
+	Cannot seek, Tell() is the uncompressed position.
+*/
+class FRamaSaveBlockWriter : public FArchive
+{
+public:
+	FRamaSaveBlockWriter(FArchive* InInner, bool bInOwnsInner, ERamaSaveCodec InCodec);
+	virtual ~FRamaSaveBlockWriter();
+
+	//nullptr if the file could not be created
+	static FRamaSaveBlockWriter* CreateFile(const FString& FullFilePath, ERamaSaveCodec InCodec);
+
+	virtual void Serialize(void* Data, int64 Num) override;
+	virtual int64 Tell() override { return UncompressedSize; }
+	virtual int64 TotalSize() override { return UncompressedSize; }
+
+	//Writes the last blocks and the block table
+	virtual bool Close() override;
+
+	virtual FString GetArchiveName() const override { return TEXT("FRamaSaveBlockWriter"); }
+
+private:
+	void WritePendingBlocks();
+
+	FArchive* Inner;
+	bool bOwnsInner;
+	bool bClosed = false;
+
+	ERamaSaveCodec Codec;
+	int32 WindowBlocks;
+
+	//Where this block file starts inside Inner, a section of a bigger file does not start at 0
+	int64 BlobBegin = 0;
+	int64 HeaderSizesPos = 0;
+	int64 UncompressedSize = 0;
+
+	TArray<uint8> Pending;
+	TArray<TArray<uint8>> Window;
+	TArray<int32> StoredSizes;
+};
+
+/*
+	Reads a block framed file, decompressing only the window of blocks around the current position.
+
+	Fully seekable, Tell() and Seek() use uncompressed positions.
+*/
+class FRamaSaveBlockReader : public FArchive
+{
+public:
+	//InWindowBlocks 0 uses the Streaming Window Size from the project settings
+	FRamaSaveBlockReader(FArchive* InInner, bool bInOwnsInner, int32 InWindowBlocks = 0);
+	virtual ~FRamaSaveBlockReader();
+
+	//nullptr if the file does not exist or is not block framed
+	static FRamaSaveBlockReader* OpenFile(const FString& FullFilePath, int32 InWindowBlocks = 0);
+
+	//Header could be read
+	bool IsValid() const { return bValid; }
+
+	virtual void Serialize(void* Data, int64 Num) override;
+	virtual void Seek(int64 InPos) override { Pos = InPos; }
+	virtual int64 Tell() override { return Pos; }
+	virtual int64 TotalSize() override { return Header.UncompressedSize; }
+	virtual bool Close() override;
+
+	virtual FString GetArchiveName() const override { return TEXT("FRamaSaveBlockReader"); }
+
+private:
+	bool LoadWindow(int32 FirstBlock);
+
+	FArchive* Inner;
+	bool bOwnsInner;
+	bool bValid = false;
+
+	FRamaSaveBlockHeader Header;
+	int32 WindowBlocks;
+	int64 Pos = 0;
+
+	//Uncompressed range currently held in Decoded
+	int64 WindowBegin = 0;
+	int64 WindowEnd = 0;
+	TArray<uint8> Decoded;
+	TArray<uint8> Stored;
+};
+
+/*
+	A range of another archive, positions relative to the start of the range.
+	Lets a block file that is one section of a bigger file be read like a file of its own.
+*/
+class FRamaSaveRangeReader : public FArchive
+{
+public:
+	FRamaSaveRangeReader(FArchive* InInner, bool bInOwnsInner, int64 InBegin, int64 InSize);
+	virtual ~FRamaSaveRangeReader();
+
+	virtual void Serialize(void* Data, int64 Num) override;
+	virtual void Seek(int64 InPos) override;
+	virtual int64 Tell() override { return Inner ? Inner->Tell() - Begin : 0; }
+	virtual int64 TotalSize() override { return Size; }
+	virtual bool Close() override;
+
+	virtual FString GetArchiveName() const override { return TEXT("FRamaSaveRangeReader"); }
+
+private:
+	FArchive* Inner;
+	bool bOwnsInner;
+	int64 Begin;
+	int64 Size;
+};
+
+/*
+	Uncompressed block file mapped into memory and read in place,
+	so only the pages that are actually read get loaded from disk.
+*/
+class FRamaSaveMappedReader : public FBufferReader
+{
+public:
+	//nullptr if the platform can't map files, or any block of the file is compressed
+	//	BlobOffset/BlobSize select a block file inside a bigger file, BlobSize -1 for the rest of the file
+	static FRamaSaveMappedReader* OpenFile(const FString& FullFilePath, int64 BlobOffset = 0, int64 BlobSize = -1);
+
+	virtual ~FRamaSaveMappedReader();
+
+	virtual FString GetArchiveName() const override { return TEXT("FRamaSaveMappedReader"); }
+
+private:
+	FRamaSaveMappedReader(IMappedFileHandle* InHandle, IMappedFileRegion* InRegion, int64 PayloadBegin, int64 PayloadSize);
+
+	IMappedFileHandle* Handle;
+	IMappedFileRegion* Region;
+};
+
+/*
+	Memory writer whose positions continue from BaseOffset,
+	so records can be built in a small scratch buffer while still recording their absolute positions in the file.
+	Older record layouts seek back within the buffer to patch end positions, so Seek is still supported.
+
+	Rebase() moves on once the scratch bytes have been handed off.
+*/
+class FRamaSaveOffsetWriter : public FArchive
+{
+public:
+	FRamaSaveOffsetWriter(TArray<uint8>& InBytes, int64 InBaseOffset = 0)
+		: Bytes(InBytes)
+		, BaseOffset(InBaseOffset)
+	{
+		ArIsSaving = true;
+		ArIsPersistent = true;
+	}
+
+	virtual void Serialize(void* Data, int64 Num) override;
+	virtual int64 Tell() override { return BaseOffset + Offset; }
+	virtual void Seek(int64 InPos) override;
+	virtual int64 TotalSize() override { return BaseOffset + Bytes.Num(); }
+
+	virtual FString GetArchiveName() const override { return TEXT("FRamaSaveOffsetWriter"); }
+
+	//Scratch bytes were written elsewhere, continue after them with an empty buffer
+	void Rebase()
+	{
+		BaseOffset += Bytes.Num();
+		Bytes.Reset();
+		Offset = 0;
+	}
+
+private:
+	TArray<uint8>& Bytes;
+	int64 BaseOffset;
+	int64 Offset = 0;
+};
\ No newline at end of file
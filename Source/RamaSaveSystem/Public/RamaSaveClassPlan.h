@@ -0,0 +1,81 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UClass;
+class UProperty;
+class UObjectProperty;
+
+/*
+	Reflection results for one class, so saving or loading thousands of actors of the same class
+	walks the class fields once instead of once per actor.
+	
+	Game thread only. A plan is rebuilt when its class is recompiled or hot reloaded.
+*/
+struct FRamaSaveClassPlan
+{
+	/** Cached plan for this class, built on first use */
+	static FRamaSaveClassPlan& Get(UClass* Class);
+	
+	/** Same result as FindField<UProperty>(Class, Name), without walking the fields */
+	UProperty* FindProperty(FName Name) const
+	{
+		UProperty* const* Found = PropertiesByName.Find(Name);
+		return Found ? *Found : nullptr;
+	}
+	
+	/** Properties named in VarsToSave, plus the ones marked SaveGame if bSaveGame, in field order */
+	const TArray<UProperty*>& GetSelection(const TArray<FString>& VarsToSave, bool bSaveGame);
+	
+	/** The object properties of GetSelection(VarsToSave, false), the ones save validity checks look at */
+	const TArray<UObjectProperty*>& GetObjectSelection(const TArray<FString>& VarsToSave);
+	
+	/** Every object property of the class, in field order */
+	const TArray<UObjectProperty*>& GetObjectProperties() const
+	{
+		return ObjectProperties;
+	}
+	
+	/** The property for each entry of VarsToSave or nullptr, same order as VarsToSave */
+	const TArray<UProperty*>& GetNamedProperties(const TArray<FString>& VarsToSave);
+	
+	/** Properties a Rama Save Component subclass added itself, in field order (empty for other classes) */
+	const TArray<UProperty*>& GetComponentProperties() const
+	{
+		return ComponentProperties;
+	}
+	
+private:
+	void Build(UClass* Class);
+	
+	//Property at the head of the class when built, recompiling a class replaces all its properties
+	TWeakObjectPtr<UProperty> BuiltFrom;
+	
+	TMap<FName, UProperty*> PropertiesByName;
+	TArray<UProperty*> FieldOrder;
+	TArray<UProperty*> ComponentProperties;
+	TArray<UObjectProperty*> ObjectProperties;
+	
+	//One per var list seen for this class, usually just one. Indirect so returned arrays stay put
+	struct FSelection
+	{
+		TArray<FString> VarsToSave;
+		bool bSaveGame;
+		bool bNamed;
+		TArray<UProperty*> Properties;
+		
+		//Filled on first use
+		bool bObjectProperties = false;
+		TArray<UObjectProperty*> ObjectProperties;
+	};
+	TIndirectArray<FSelection> Selections;
+	
+	//Selection indices by the hash of their key, so a lookup compares var lists only on a hash match
+	TMultiMap<uint32, int32> SelectionsByHash;
+	
+	FSelection& FindOrAddSelection(const TArray<FString>& VarsToSave, bool bSaveGame);
+	FSelection* FindSelection(const TArray<FString>& VarsToSave, bool bSaveGame, bool bNamed, uint32& OutHash);
+	FSelection& AddSelection(const TArray<FString>& VarsToSave, bool bSaveGame, bool bNamed, uint32 Hash);
+};
\ No newline at end of file
@@ -2,8 +2,11 @@
 #pragma once
  
 #include "RamaSaveUtility.h"
+#include "RamaSaveArchive.h"
 
 #include "RamaSaveComponent.generated.h"
+
+struct FRamaSaveActorSnapshot;
   
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams( FRamaSaveFullyLoadedSignature, class URamaSaveComponent*, RamaSaveComponent, FString, LevelPackageName );
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam( FRamaSavePreSaveSignature, class URamaSaveComponent*, RamaSaveComponent );
@@ -174,6 +177,11 @@ public:
 	}
 	#endif
 	
+	//Kept in the world's FRamaSaveRegistry while registered
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+	TWeakObjectPtr<UWorld> RegisteredWorld;
+	
 	/** Whether to log information regarding Actor GUID Saving and Loading */
 	UPROPERTY(Category="Rama Save System", EditDefaultsOnly, BlueprintReadWrite)
 	bool RamaSave_LogPersistentActorGUID = true;
@@ -182,8 +190,11 @@ public:
 		Add tags to instances of an actor class / blueprint so you can identify to my save system which actors you want to load.
 		
 		These tags are optional, and are ideal for things like level streaming or any other game-specific conditions where you want to selectively load actors based on your own game's needs.
+		
+		Setting this in blueprints goes through RamaSave_SetSaveTags, so Get All Rama Save Components With Tags sees the change right away.
+		From C++, or when editing the array in place, use RamaSave_AddSaveTag / RamaSave_RemoveSaveTag / RamaSave_SetSaveTags or call RamaSave_SaveTagsChanged after.
 	*/
-	UPROPERTY(Category="Rama Save System", EditAnywhere, BlueprintReadWrite)
+	UPROPERTY(Category="Rama Save System", EditAnywhere, BlueprintReadWrite, BlueprintSetter=RamaSave_SetSaveTags)
 	TArray<FString> RamaSave_SaveTags;
 	
 	UFUNCTION(Category="Rama Save System", BlueprintPure)
@@ -192,6 +203,19 @@ public:
 		return RamaSave_SaveTags.Contains(SaveTag);
 	}
 	
+	UFUNCTION(Category="Rama Save System", BlueprintCallable)
+	void RamaSave_AddSaveTag(FString SaveTag);
+	
+	UFUNCTION(Category="Rama Save System", BlueprintCallable)
+	void RamaSave_RemoveSaveTag(FString SaveTag);
+	
+	UFUNCTION(Category="Rama Save System", BlueprintCallable)
+	void RamaSave_SetSaveTags(const TArray<FString>& SaveTags);
+	
+	/** Tag queries use an index of the save tags, call this if you changed RamaSave_SaveTags directly. Saving and loading the actor also updates it. */
+	UFUNCTION(Category="Rama Save System", BlueprintCallable)
+	void RamaSave_SaveTagsChanged();
+	
 	/** This function tells you which streaming level the owner of this component is part of!!!! Yes!!! Those of you using UE4's Level Streaming system will love me for this! <3 Rama */
 	UFUNCTION(Category="Rama Save System", BlueprintPure)
 	FString GetActorStreamingLevelPackageName();
@@ -316,22 +340,52 @@ public:
 
 	//Make a setting struct eventually instead of just passing the single bool of DontLoadPlayerPawns
 	
-	bool RamaSave_SaveToFile(UWorld* World, FArchive &Ar);
-	static bool RamaSave_LoadFromFile(UWorld* World, int32 RamaSaveSystemVersion, const TArray<FString>& LoadActorsWithSaveTags, FArchive &Ar, URamaSaveComponent*& LoadedComp, bool DontLoadPlayerPawns, FString LoadOnlyStreamingLevel="");
+	bool RamaSave_SaveToFile(UWorld* World, FRamaSaveArchive &Ar);
+	
+	//Gather everything the actor record is written from, false if nothing can be saved
+	bool TakeSnapshot(UWorld* World, FRamaSaveActorSnapshot& Snapshot);
+	
+	static bool RamaSave_LoadFromFile(UWorld* World, int32 RamaSaveSystemVersion, const TArray<FString>& LoadActorsWithSaveTags, FRamaSaveArchive &Ar, URamaSaveComponent*& LoadedComp, bool DontLoadPlayerPawns, FString LoadOnlyStreamingLevel="");
+	
+	//Split up version of RamaSave_LoadFromFile, the first two are safe on worker threads
+	static void ReadActorRecordHeader(FRamaSaveArchive &Ar, int32 RamaSaveSystemVersion, FRamaSaveActorRecord& Record);
+	static bool ShouldLoadActorRecord(const FRamaSaveActorRecord& Record, const TArray<FString>& LoadActorsWithSaveTags, const FString& LoadOnlyStreamingLevel);
+	static bool RamaSave_LoadFromRecord(UWorld* World, const FRamaSaveActorRecord& Record, FRamaSaveArchive &Ar, URamaSaveComponent*& LoadedComp, bool DontLoadPlayerPawns, TMap<FString, UClass*>* ClassCache = nullptr);
+	
+	//Class to spawn for a record, nullptr if it no longer exists
+	static UClass* ResolveActorClass(const FRamaSaveActorRecord& Record);
 	
 public:
-	void SaveSelfAndSubclassVariables(FArchive &Ar);
-	void LoadSelfAndSubclassVariables(FArchive &Ar);
+	void SnapshotSelfAndSubclassVariables(FRamaSaveActorSnapshot& Snapshot);
+	void LoadSelfAndSubclassVariables(FRamaSaveArchive &Ar);
 	
-	void SaveOwnerVariables(UWorld* World, FArchive &Ar);
-	void SaveOwnerVariables_Pawn(APawn* Pawn, UWorld* World, FArchive &Ar);
-	void SaveOwnerVariables_Physics(AActor* ActorOwner, UWorld* World, FArchive &Ar);
-	void SaveSubComponentVariables(AActor* ActorOwner, UWorld* World, FArchive &Ar);
+	void SnapshotOwnerVariables(UWorld* World, FRamaSaveActorSnapshot& Snapshot);
+	void SnapshotOwnerVariables_Pawn(APawn* Pawn, UWorld* World, FRamaSaveActorSnapshot& Snapshot);
+	void SnapshotOwnerVariables_Physics(AActor* ActorOwner, FRamaSaveActorSnapshot& Snapshot);
+	void SnapshotSubComponentVariables(AActor* ActorOwner, FRamaSaveActorSnapshot& Snapshot);
 	
-	void LoadOwnerVariables(UWorld* World, FArchive &Ar);
+	void LoadOwnerVariables(UWorld* World, FRamaSaveArchive &Ar);
 	void LoadOwnerVariables_Pawn(APawn* Pawn, UWorld* World, FArchive &Ar);
-	void LoadOwnerVariables_Physics(AActor* ActorOwner, UWorld* World, FArchive &Ar);
-	void LoadSubComponentVariables(AActor* ActorOwner, UWorld* World, FArchive &Ar);
+	void LoadOwnerVariables_Physics(AActor* ActorOwner, UWorld* World, FRamaSaveArchive &Ar);
+	void LoadSubComponentVariables(AActor* ActorOwner, UWorld* World, FRamaSaveArchive &Ar);
+	
+	//One property entry, name plus sized value
+	static void SaveProperty(FRamaSaveArchive &Ar, UProperty* Property, void* Container);
+	static void SavePropertyAt(FRamaSaveArchive &Ar, UProperty* Property, uint8* ValuePtr);
+	static int64 LoadPropertyHeader(FRamaSaveArchive &Ar, FName& PropertyName);
+	static int64 LoadPropertyHeader(FRamaSaveArchive &Ar, const FRamaSaveLayout* Layout, int32 Ordinal, FName& PropertyName);
+	static void SavePropertyValue(FRamaSaveArchive &Ar, UProperty* Property, uint8* ValuePtr);
+	static void LoadPropertyValue(FRamaSaveArchive &Ar, UProperty* Property, uint8* ValuePtr, int64 EndPos);
+	static bool IsRawProperty(UProperty* Property);
+	
+	//Property blocks, count or layout then the entries
+	static void SavePropertyBlockHeader(FRamaSaveArchive &Ar, TArrayView<UProperty* const> Properties);
+	static const FRamaSaveLayout* LoadPropertyBlockHeader(FRamaSaveArchive &Ar, int64& TotalProperties);
+	static void LoadPropertyBlock(FRamaSaveArchive &Ar, const FRamaSaveLayout* Layout, int64 TotalProperties, UObject* Container);
+	static bool MatchesArchetype(UProperty* Property, UObject* Container);
+	
+	//SaveOnlyPropertiesChangedFromDefaults, only for actors that loading spawns, a GUID can match an existing actor that would keep stale values
+	bool SavesOnlyChangedProperties() const;
 	
 	//Name conflict with UObject::PreSave
 	void RamaCPP_PreSave();
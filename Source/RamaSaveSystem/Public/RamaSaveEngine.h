@@ -5,15 +5,27 @@
 #pragma once
 
 #include "RamaSaveObject.h"
+#include "RamaSaveUtility.h"
 #include "ObjectAndNameAsStringProxyArchive.h"
+#include "Engine/StreamableManager.h"
 #include "RamaSaveEngine.generated.h"
+
+struct FRamaSaveSnapshotBatch;
  
 //Version
-#define JOY_SAVE_VERSION 6
+#define JOY_SAVE_VERSION 14
 
 #define JOY_SAVE_VERSION_STREAMINGLEVELS 4
 #define JOY_SAVE_VERSION_MULTISUBCOMPONENT_SAMENAME 5
 #define JOY_SAVE_VERSION_SAVEOBJECT 6
+#define JOY_SAVE_VERSION_SECTIONS 7
+#define JOY_SAVE_VERSION_STRINGTABLE 8
+#define JOY_SAVE_VERSION_DIRECTORY 9
+#define JOY_SAVE_VERSION_SIZEDRECORDS 10
+#define JOY_SAVE_VERSION_LAYOUTS 11
+#define JOY_SAVE_VERSION_RAWVALUES 12
+#define JOY_SAVE_VERSION_OBJECTTABLE 13
+#define JOY_SAVE_VERSION_OBJECTREFS 14
 
 USTRUCT()
 struct FRamaSaveEngineParams
@@ -60,30 +72,75 @@ public:
 	UFUNCTION(BlueprintImplementableEvent, Category="Rama Save System")
 	void Async_SaveCancelled(const FString& FileName);
 	
+	/** The async save could not write its file, instead of Async_SaveFinished */
+	UFUNCTION(BlueprintImplementableEvent, Category="Rama Save System")
+	void Async_SaveFailed(const FString& FileName);
+	
+	/** The file passed the checks of the load node, but its actors could not be decompressed or parsed */
+	UFUNCTION(BlueprintImplementableEvent, Category="Rama Save System")
+	void Async_LoadFailed(const FString& FileName);
+	
 //Saving
 public:
 	
 	//SYNC
-	void RamaSave_SaveToFile(FString FileName, bool& FileIOSuccess, bool& AllComponentsSaved, FString SaveOnlyStreamingLevel="", URamaSaveObject* StaticSaveData = nullptr);
+	void RamaSave_SaveToFile(FString FileName, bool& FileIOSuccess, bool& AllComponentsSaved, FString SaveOnlyStreamingLevel="", URamaSaveObject* StaticSaveData = nullptr, ERamaSaveCodec Codec = ERamaSaveCodec::UseProjectDefault);
 	
 	UPROPERTY()
 	TArray<URamaSaveComponent*> RamaSaveComponents;
 	
+	/** Serialization buffers reused across saves, trimmed on memory pressure */
+	FRamaSaveBufferPool SaveBufferPool;
+	FDelegateHandle MemoryTrimHandle;
+	void TrimSaveBuffers();
+	
+	//Buffers that async compression tasks are done with
+	void CollectFinishedSaveBuffers();
+	
+	//Save On Worker Thread, snapshots whose encode task may still be running, their copied values are reported to garbage collection
+	TArray<TSharedPtr<FRamaSaveSnapshotBatch, ESPMode::ThreadSafe>> PendingSnapshots;
+	void StartEncodeTask(const TSharedPtr<FRamaSaveSnapshotBatch, ESPMode::ThreadSafe>& Snapshots, FRamaSaveFileSections&& Sections, TArray<uint8>&& ToBinary, const FString& FileName, ERamaSaveCodec Codec);
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+	
+	//!#5 Total, !#6 the records of each index, then !#7 - #9 the tables, streamed to the file or written all at once. Safe on worker threads
+	static bool WriteActorsFile(const FString& FileName, FRamaSaveFileSections& Sections, TArray<uint8>& ToBinary, ERamaSaveCodec Codec, bool bStreaming, FRamaSaveStringTable& Strings, FRamaSaveLayoutTable& Layouts, int32 TotalComponents, int32 RecordCount, TFunctionRef<bool(FRamaSaveArchive&, int32)> WriteRecord, bool& AllRecordsWritten);
+	
+	//Parallel Save, every record of RamaSaveComponents encoded across worker threads, then written in order
+	bool RamaSave_SaveInParallel(UWorld* World, const FString& FileName, FRamaSaveFileSections& Sections, TArray<uint8>& ToBinary, ERamaSaveCodec Codec, bool bStreaming, int32 TotalComponents, bool& AllComponentsSaved);
+	
 	//ASYNC
-	void RamaSave_SaveToFile_ASYNC(FString FileName, bool& FileIOSuccess, bool& AllComponentsSaved, FString SaveOnlyStreamingLevel="", URamaSaveObject* StaticSaveData = nullptr);
+	void RamaSave_SaveToFile_ASYNC(FString FileName, bool& FileIOSuccess, bool& AllComponentsSaved, FString SaveOnlyStreamingLevel="", URamaSaveObject* StaticSaveData = nullptr, ERamaSaveCodec Codec = ERamaSaveCodec::UseProjectDefault);
 	
+	FRamaSaveFileSections RamaSaveAsync_Sections;
 	TArray<uint8> RamaSaveAsync_ToBinary;
-	FObjectAndNameAsStringProxyArchive* AsyncArchive = nullptr;
+	FRamaSaveStringTable RamaSaveAsync_Strings;
+	FRamaSaveActorDirectory RamaSaveAsync_Directory;
+	FRamaSaveLayoutTable RamaSaveAsync_Layouts;
+	FRamaSaveArchive* AsyncArchive = nullptr;
 	FMemoryWriter* AsyncMemoryWriter = nullptr;
+	TSharedPtr<FRamaSaveSnapshotBatch, ESPMode::ThreadSafe> RamaSaveAsync_Snapshots;		//Instead of the archive with Save On Worker Thread
 	void ClearAsyncArchive();
 	
 	FTimerHandle TH_CheckCompressToFileFinished;
+	TSharedPtr<FRamaSaveWriteResult, ESPMode::ThreadSafe> PendingWriteResult;		//Shared with the running save task
 	void CheckCompressToFileFinished();
 	bool RamaSaveAsync_SaveChecks = false;
 	FString RamaSaveAsync_FileName;
+	ERamaSaveCodec RamaSaveAsync_Codec = ERamaSaveCodec::Zlib;
 	int32 RamaSaveAsync_TotalComponents;
 	int32 RamaSaveAsync_Index = 0;
 	int32 RamaSaveAsync_ChunkGoal = 1;
+	
+	//Frame budget scheduler, see AsyncSaveFrameBudgetMs
+	float RamaSaveAsync_BudgetMs = 0;
+	float RamaSaveAsync_ActorCostMs = 0;		//Moving average of the time to save one actor
+	uint64 RamaSaveAsync_BudgetFrame = 0;
+	float RamaSaveAsync_FrameSpentMs = 0;
+	int32 RamaSaveAsync_FrameActors = 0;
+	int32 RamaSaveAsync_Frames = 0;
+	int32 RamaSaveAsync_ActorsSaved = 0;
+	double RamaSaveAsync_SpentMs = 0;
+	void RamaSaveAsync_LogThroughput();
 	FTimerHandle TH_RamaSaveAsync;
 	void RamaSaveAsync();
 	void RamaSaveAsync_Finish();
@@ -96,8 +153,21 @@ public:
 	UPROPERTY()
 	FRamaSaveEngineParams LoadParams;
 	
+	/** The file being loaded, decompressed once and shared by Phase1 and Phase2. Released when Phase2 finishes. */
+	FRamaSaveDecodedFilePtr LoadDecodedFile;
+	
+	//Decompress and pre-parse LoadParams.FileName on a worker thread
+	void StartLoadDecode();
+	FTimerHandle TH_WaitForDecode;
+	
+	//Worker thread, fills in everything but FileName and the flags
+	static bool ParseDecodedFile(FArchive& Reader, FRamaSaveDecodedFile& File, const FRamaSaveEngineParams& Params);
+	static bool ParseSectionedFile(class FRamaSaveSectionReader& Sections, FRamaSaveDecodedFile& File, const FRamaSaveEngineParams& Params);
+	static bool ParseActorRecords(FArchive& Reader, FRamaSaveDecodedFile& File, const FRamaSaveEngineParams& Params);
+	
 	//Unload/Load appropriate Levels
 	void Phase1(const FRamaSaveEngineParams& Params, bool HandleStreamingLevelsLoadingAndUnloading);
+	void Phase1_StreamingLevels();
 	
 	float AsyncStartTime = 0;
 	
@@ -110,12 +180,22 @@ public:
 	//Loooooooaaaaaaadddddd!!!
 	void Phase2();
 	
+	//Between Phase1 and Phase2, streams in the actor classes and assets the file references
+	//	so spawning and property loading never wait on disk. Returns true if Phase2 will be called when done.
+	bool Phase2_Preload(const FRamaSaveDecodedFile& File);
+	static bool ShouldPreload(const FString& Path);
+	FStreamableManager PreloadStreamable;
+	TSharedPtr<FStreamableHandle> PreloadHandle;
+	
 	//What file version is being loaded?
 	static int32 LoadedSaveVersion;
 	
 	
-	void SaveStaticData(FArchive& Ar, URamaSaveObject* StaticData);
-	void SkipStaticData(FArchive& Ar);
+	//Header, streaming level state and static data, each written to its own section of the file
+	void SaveFileSections(UWorld* World, URamaSaveObject* StaticSaveData, FRamaSaveFileSections& Sections);
+	
+	void SaveStaticData(FRamaSaveArchive& Ar, URamaSaveObject* StaticData);
+	static void SkipStaticData(FArchive& Ar);
 	
 	static URamaSaveObject* LoadStaticData(bool& FileIOSuccess,  FString FileName);
 	
@@ -36,6 +36,8 @@ public:
 		
 		@param StaticSaveData For any simple data that is not associated with an actor that you want to be able to load even before the world has finished being created,  make a BP of my RamaSaveObject class and put all your data there! You can use Construct Object to create an instance of the RamaSaveObject and use it any where you like, then pass that instance to this save function at the time of saving.
 		
+		@param Codec How to compress this save, for example Fast for autosaves and HighRatio for manual saves. Any codec can be loaded without specifying it again.
+		
 		<3 Rama 
 	*/
 	UFUNCTION(Category="Rama Save System", BlueprintCallable,meta=(WorldContext="WorldContextObject"))
@@ -45,7 +47,8 @@ public:
 		bool& FileIOSuccess, 
 		bool& AllComponentsSaved, 
 		FString SaveOnlyStreamingLevel="",
-		URamaSaveObject* StaticSaveData = nullptr
+		URamaSaveObject* StaticSaveData = nullptr,
+		ERamaSaveCodec Codec = ERamaSaveCodec::UseProjectDefault
 	);
 	
 	/** If you are using Async Saving then you can cancel after starting (and before it was going to finish) using this node! Returns true if an async save was in progress and was cancelled, false if no save was in process. */
@@ -113,6 +116,9 @@ public:
 		
 		@param LoadOnlyStreamingLevel Optional param to only load actors from a specific streaming level! Use "PersistentLevel" to load only non-streaming main level actors.
 		
+		FileIOSuccess is false if the file is missing, is not a save file or is from a newer version. The actors are read after this returns, 
+		if they turn out to be corrupt the Rama Save Engine calls Async_LoadFailed.
+		
 		<3 RAma
 	*/
 	UFUNCTION(Category="Rama Save System", BlueprintCallable,meta=(WorldContext="WorldContextObject", AutoCreateRefTerm = "LoadOnlyActorsWithSaveTags"))
@@ -296,4 +302,18 @@ public:
 public:
 	static bool VerifyActorAndComponentProperties(URamaSaveComponent* SaveComp);
 	
+	//VerifyActorAndComponentProperties for every comp, the property values read across worker threads while the game thread waits.
+	//	Returns the first comp that failed, in array order, after reporting it the same way, or nullptr
+	static URamaSaveComponent* VerifyAllActorAndComponentProperties(const TArray<URamaSaveComponent*>& SaveComps);
+	
+	//Split up version of VerifyActorAndComponentProperties, FindUnloadableObjectProperty only reads the values
+	static UObjectProperty* FindUnloadableObjectProperty(UObject* Container, const TArray<UObjectProperty*>& ObjectProperties);
+	static void ReportUnloadableObjectProperty(URamaSaveComponent* SaveComp, UObjectProperty* ObjProp, bool bOwningActor);
+	
+	/** Whether a file can be loaded at all, its section table or block table and its version, without reading the actors */
+	static bool CheckSaveFileHeader(const FString& FileName);
+	
+	/** Streaming level states from the start of a file, see RamaSave_LoadStreamingStateFromFile */
+	static int32 ReadStreamingState(FArchive& MemoryReader, TArray<FString>& StreamingLevelsStates);
+	
 };
\ No newline at end of file
@@ -0,0 +1,93 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UWorld;
+class ULevel;
+class URamaSaveComponent;
+
+/*
+	The Rama Save Components of one world, kept up to date as components register and unregister,
+	so loading can find a persistent actor by its GUID and saving, clearing and queries only visit
+	the components of the levels and save tags they ask for, without searching every actor or object.
+	
+	Game thread only.
+*/
+class FRamaSaveRegistry
+{
+public:
+	/** Registry of this world, created on first use */
+	static FRamaSaveRegistry* Get(UWorld* World);
+	
+	/** Registry of this world, nullptr if no component ever registered in it */
+	static FRamaSaveRegistry* Find(UWorld* World);
+	
+	void Add(URamaSaveComponent* Comp);
+	void Remove(URamaSaveComponent* Comp);
+	
+	/** Component whose RamaSave_PersistentActorUniqueID is Guid, first registered wins if several share it */
+	URamaSaveComponent* FindByGuid(const FGuid& Guid);
+	
+	/** Live components whose owner is in the level with this package name, or in any level if it is empty */
+	void GetComponents(const FString& LevelPackageName, TArray<URamaSaveComponent*>& OutComponents) const;
+	
+	/** Same as URamaSaveComponent::GetActorStreamingLevelPackageName for actors in Level, nullptr if no component registered from it */
+	const FString* FindLevelPackageName(ULevel* Level) const
+	{
+		const FLevelBucket* Bucket = Levels.Find(Level);
+		return Bucket ? &Bucket->PackageName : nullptr;
+	}
+	
+	static FString GetLevelPackageName(UWorld* World, ULevel* Level);
+	
+	/** Live components that have any of SaveTags, optionally only in one level. Visits only the components with those tags */
+	void GetComponentsWithTags(const TArray<FString>& SaveTags, const FString& LevelPackageName, TArray<URamaSaveComponent*>& OutComponents) const;
+	
+	/** Re-index the save tags of a registered component after its RamaSave_SaveTags changed, nothing to do if they did not */
+	void UpdateTags(URamaSaveComponent* Comp);
+	
+	int32 Num() const
+	{
+		return Components.Num();
+	}
+	
+private:
+	void AddGuid(URamaSaveComponent* Comp, const FGuid& Guid);
+	void RemoveGuid(URamaSaveComponent* Comp, const FGuid& Guid);
+	
+	void AddTags(URamaSaveComponent* Comp, const TArray<FName>& Tags);
+	void RemoveTags(URamaSaveComponent* Comp, const TArray<FName>& Tags);
+	static void InternTags(const TArray<FString>& SaveTags, TArray<FName>& OutTags);
+	
+	//GUIDs can be set from Blueprint after the component registered
+	void RefreshGuids();
+	uint64 GuidsRefreshedFrame = MAX_uint64;
+	
+	//Registered component, and the GUID, level and tags it is indexed under
+	struct FEntry
+	{
+		FGuid Guid;
+		TWeakObjectPtr<ULevel> Level;
+		TArray<FName> Tags;
+		
+		//RamaSave_SaveTags as they were indexed, so an unchanged component costs one compare
+		TArray<FString> SaveTags;
+	};
+	TMap<TWeakObjectPtr<URamaSaveComponent>, FEntry> Components;
+	
+	//Package name worked out once per level instead of once per actor
+	struct FLevelBucket
+	{
+		FString PackageName;
+		TSet<TWeakObjectPtr<URamaSaveComponent>> Components;
+	};
+	TMap<TWeakObjectPtr<ULevel>, FLevelBucket> Levels;
+	
+	TMap<FGuid, TWeakObjectPtr<URamaSaveComponent>> ByGuid;
+	TMultiMap<FGuid, TWeakObjectPtr<URamaSaveComponent>> Duplicates;
+	
+	//Tags interned to FNames, same case insensitive match as comparing the FStrings
+	TMap<FName, TSet<TWeakObjectPtr<URamaSaveComponent>>> ByTag;
+};
\ No newline at end of file
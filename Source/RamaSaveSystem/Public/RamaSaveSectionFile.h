@@ -0,0 +1,114 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#pragma once
+
+#include "RamaSaveBlockArchive.h"
+
+/*
+	Sectioned Save File Layout (JOY_SAVE_VERSION_SECTIONS+)
+
+	uint32 	Magic
+	uint32 	Version
+	int32 	NumSections
+	FRamaSaveSectionEntry 	Sections[NumSections] 	uncompressed, so any section can be found with a few bytes of IO
+	uint8 	Section blobs 	each one a block framed file of its own, see RamaSaveBlockArchive.h
+
+	Streaming level state and static data can be read without touching the actor payload.
+*/
+namespace RamaSaveSectionFile
+{
+	const uint32 Magic = 0x46535352;	//"RSSF"
+	const uint32 Version = 1;
+
+	enum ESection : uint32
+	{
+		Header,			//int32 SaveVersion, int32 UE4 Version, FEngineVersion
+		Streaming,		//TArray<FString> level names, TBitArray<> visible
+		StaticData,		//uint8 HasStaticData, static data
+		Actors,			//int32 TotalComponents, actor records
+		Strings,		//FRamaSaveStringTable used by the actor records (JOY_SAVE_VERSION_STRINGTABLE+)
+		Directory,		//FRamaSaveActorDirectory (JOY_SAVE_VERSION_DIRECTORY+)
+		Layouts,		//FRamaSaveLayoutTable used by the property blocks (JOY_SAVE_VERSION_LAYOUTS+)
+
+		Count
+	};
+}
+
+struct FRamaSaveSectionEntry
+{
+	uint32 Id = 0;
+	int64 Offset = 0;
+	int64 StoredSize = 0;
+	int64 RawSize = 0;
+	uint8 Codec = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FRamaSaveSectionEntry& Entry)
+	{
+		Ar << Entry.Id;
+		Ar << Entry.Offset;
+		Ar << Entry.StoredSize;
+		Ar << Entry.RawSize;
+		Ar << Entry.Codec;
+		return Ar;
+	}
+};
+
+/*
+	Writes the sections one after the other, the section table is filled in by Close().
+
+	A section can be written all at once with WriteSection,
+	or streamed through the archive from BeginSection until EndSection.
+*/
+class FRamaSaveSectionWriter
+{
+public:
+	//nullptr if the file could not be created
+	static FRamaSaveSectionWriter* CreateFile(const FString& FullFilePath);
+	~FRamaSaveSectionWriter();
+
+	FArchive& BeginSection(uint32 Id, ERamaSaveCodec Codec);
+	void EndSection();
+
+	void WriteSection(uint32 Id, const TArray<uint8>& Raw, ERamaSaveCodec Codec);
+
+	bool Close();
+
+private:
+	FRamaSaveSectionWriter(FArchive* InFile);
+
+	FArchive* File;
+	bool bError = false;
+
+	int64 TablePos = 0;
+	TArray<FRamaSaveSectionEntry> Sections;
+
+	TUniquePtr<FRamaSaveBlockWriter> Current;
+	uint32 CurrentId = 0;
+};
+
+/** Reads the section table of a file, then any section on its own */
+class FRamaSaveSectionReader
+{
+public:
+	//nullptr if the file does not exist or is not sectioned
+	static FRamaSaveSectionReader* OpenFile(const FString& FullFilePath);
+	~FRamaSaveSectionReader();
+
+	const FRamaSaveSectionEntry* FindSection(uint32 Id) const;
+
+	//Entire section decompressed, for the small ones
+	bool ReadSection(uint32 Id, TArray<uint8>& OutRaw);
+
+	/*
+		Reader for a big section, caller owns it.
+		Memory mapped if stored uncompressed, a window at a time if bAllowStreaming,
+		otherwise decompressed into OutBuffer which must outlive the reader.
+	*/
+	FArchive* OpenSection(uint32 Id, bool bAllowStreaming, TArray<uint8>& OutBuffer);
+
+private:
+	FRamaSaveSectionReader(FArchive* InFile, const FString& InFileName);
+
+	FArchive* File;
+	FString FileName;
+	TArray<FRamaSaveSectionEntry> Sections;
+};
\ No newline at end of file
@@ -0,0 +1,128 @@
+// Copyright 2015 by Nathan "Rama" Iyer. All Rights Reserved.
+#pragma once
+
+#include "RamaSaveComponent.h"
+
+/*
+	Values of one block of properties, in the order they are written.
+	
+	Either points at the live values, when the block is written right away,
+	or owns a copy of them so the block can be written later on another thread.
+*/
+struct FRamaSavePropertyBlock
+{
+	FRamaSavePropertyBlock() {}
+	~FRamaSavePropertyBlock();
+	
+	FRamaSavePropertyBlock(const FRamaSavePropertyBlock&) = delete;
+	FRamaSavePropertyBlock& operator=(const FRamaSavePropertyBlock&) = delete;
+	
+	void Add(UProperty* Property, void* Container)
+	{
+		Properties.Add(Property);
+		Values.Add(Property->ContainerPtrToValuePtr<uint8>(Container));
+	}
+	
+	//Copy the values added so far out of their objects, one allocation for the whole block
+	void CopyValues();
+	
+	//Count or layout, then each property with its value
+	void WriteHeader(FRamaSaveArchive& Ar);
+	void WriteValues(FRamaSaveArchive& Ar, const FString& ActorName);
+	
+	//Copied values can reference objects, reported to garbage collection until they are written
+	void AddReferencedObjects(FReferenceCollector& Collector);
+	
+	//Path of every object the copied values reference, so the worker never asks a live object for it
+	void CollectObjectPaths(TMap<UObject*, FString>& ObjectPaths);
+	
+	//Once written, so garbage collection no longer has to wait on the block
+	void DestroyValues();
+	
+	TArray<UProperty*, TInlineAllocator<16>> Properties;
+	TArray<uint8*, TInlineAllocator<16>> Values;
+	
+private:
+	TArray<uint8, TAlignedHeapAllocator<16>> Memory;
+	bool bCopied = false;
+};
+
+/*
+	Everything one actor record is written from, gathered on the game thread by URamaSaveComponent::TakeSnapshot.
+	
+	With copied values, Write only touches the snapshot, never the actor, so it can run on a worker thread
+	while the game goes on (with garbage collection held off while a record is written, the values can reference objects).
+*/
+struct FRamaSaveActorSnapshot
+{
+	//For warnings
+	FString ActorName;
+	
+	//! #4 Record header
+	FString ActorClass;
+	FString ActorClassFullPath;
+	FGuid PersistentActorUniqueID;
+	TArray<FString> SaveTags;
+	FString LevelPackageName;
+	
+	//! #5 Properties
+	FRamaSavePropertyBlock Self;
+	FRamaSavePropertyBlock Owner;
+	
+	//! #7 Pawn
+	bool bPawn = false;
+	bool bIsPlayer = false;
+	FVector PawnVelocity = FVector::ZeroVector;
+	FRotator ControlRotation = FRotator::ZeroRotator;
+	int32 PlayerIndex = -1;
+	
+	//! #8 Physics, one per primitive component, only simulating ones have a state
+	bool bPhysics = false;
+	TArray<bool> Simulating;
+	TArray<FRBSave> PhysStates;
+	
+	//Sub components, one block across all comps the old way, one block per comp with SaveAllPropertiesMarkedAsSaveGame
+	bool bSubComponentsPerComp = false;
+	FRamaSavePropertyBlock SubComponents;
+	TArray<FName> CompNames;
+	TIndirectArray<FRamaSavePropertyBlock> CompBlocks;
+	
+	//Filled by Write, string table entries of the objects the values reference, for the directory
+	TArray<uint32> ObjectIndices;
+	
+	//Copy every block out of the actor
+	void CopyValues();
+	void DestroyValues();
+	void CollectObjectPaths(TMap<UObject*, FString>& ObjectPaths);
+	
+	//The whole record, same bytes as URamaSaveComponent::RamaSave_SaveToFile.
+	//	False if an object it references could not be written
+	bool Write(FRamaSaveArchive& Ar);
+	
+	//Layouts of every block Write uses, in the same order, so records written from several threads only look them up
+	void AddLayouts(FRamaSaveLayoutTable& Layouts, FRamaSaveStringTable& Strings);
+	
+	void AddReferencedObjects(FReferenceCollector& Collector);
+};
+
+/** Snapshots of one save, shared by the game thread (for garbage collection) and the task that writes them */
+struct FRamaSaveSnapshotBatch
+{
+	TIndirectArray<FRamaSaveActorSnapshot> Snapshots;
+	int32 TotalComponents = 0;
+	
+	//Filled on the game thread, for FRamaSaveStringTable::ObjectPaths
+	TMap<UObject*, FString> ObjectPaths;
+	
+	//Snapshot with copied values, same result as URamaSaveComponent::RamaSave_SaveToFile
+	bool Add(UWorld* World, URamaSaveComponent* Comp);
+	
+	void AddReferencedObjects(FReferenceCollector& Collector)
+	{
+		for(FRamaSaveActorSnapshot& Each : Snapshots)
+		{
+			Each.AddReferencedObjects(Collector);
+		}
+	}
+};
+typedef TSharedPtr<FRamaSaveSnapshotBatch, ESPMode::ThreadSafe> FRamaSaveSnapshotBatchPtr;
\ No newline at end of file
@@ -75,8 +75,79 @@ public:
 	UPROPERTY(config, Category = "Async Save", EditAnywhere, BlueprintReadWrite, meta = (editcondition = "AsyncSave"))
 	float AsyncSaveActorChunkSize = 1;
 	
+	/** 
+		If above 0, each frame saves as many actors as fit in this many milliseconds instead of a fixed Actor Chunk Size.
+		
+		The time each actor takes is measured as the save goes, and a frame stops before the next actor would likely go over the budget. At least one actor is saved per frame.
+		
+		Keep Async Save Tick Interval at or below your frame time so the save runs every frame. The achieved throughput is logged when the save finishes.
+	*/
+	UPROPERTY(config, Category = "Async Save", EditAnywhere, BlueprintReadWrite, meta = (editcondition = "AsyncSave", ClampMin = "0"))
+	float AsyncSaveFrameBudgetMs = 0;
+	
+	/** 
+		How save files are compressed, unless the save node picks its own codec.
+		
+		None is the fastest by far but files are much larger, Fast is a good choice for frequent autosaves.
+		
+		Any file can always be loaded no matter which codec it was saved with.
+	*/
+	UPROPERTY(config, Category = "Performance", EditAnywhere, BlueprintReadWrite)
+	ERamaSaveCodec CompressionCodec = ERamaSaveCodec::Zlib;
+	
+	/** 
+		For huge worlds! Saving and loading go through a window of compressed blocks directly to and from the file, 
+		instead of holding the entire world in memory at once. Needed for save files larger than 2 GB.
+		
+		Async Save still builds the save in memory, unless Save On Worker Thread is on.
+	*/
+	UPROPERTY(config, Category = "Performance", EditAnywhere, BlueprintReadWrite)
+	bool StreamingSaveLoad = false;
+	
+	/** 
+		The game thread only copies the values being saved (properties, transforms and physics state) out of each actor, 
+		then a worker thread writes the actor records, string table, compression and file while the game goes on.
+		
+		Only used by Async Save, each tick copies its chunk of actors and the worker starts once they are all copied.
+		Async Save Finished is called once the file is written, or Async Save Failed if it could not be. Files are the same as without this.
+	*/
+	UPROPERTY(config, Category = "Performance", EditAnywhere, BlueprintReadWrite)
+	bool SaveOnWorkerThread = false;
+	
+	/** 
+		For saving at a checkpoint, loading screen or pause menu, when nothing changes actors while the save runs.
+		
+		The actor records are split across all worker threads, then written in the same order as always, the same world always gives the same file. 
+		The object validity checks of every actor run across worker threads too, before any pre save event.
+		The game thread still runs the pre save events and gathers what each actor saves, and is blocked until the file is written.
+		
+		Each record is encoded once with a string table per worker chunk, merged into the file's table in record order as the records are written.
+		With Streaming Save Load only a few streaming windows of records are held in memory at a time.
+		
+		Only turn this on if no other thread (your own tasks included) changes actors or their components during a save. 
+		
+		Used by saves that are not Async Save.
+	*/
+	UPROPERTY(config, Category = "Performance", EditAnywhere, BlueprintReadWrite)
+	bool ParallelSave = false;
+	
+	/** How much uncompressed save data (in MB) is compressed or decompressed at a time, the memory used by Streaming Save Load is a small multiple of this */
+	UPROPERTY(config, Category = "Performance", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1, ClampMax = 1024))
+	int32 StreamingWindowSizeMB = 16;
+	
+	/** 
+		Only save actor and component properties whose value differs from the class defaults (or the archetype), 
+		for maps with lots of placed actors that only differ from their class in a few properties like the transform.
+		
+		Loading spawns actors from their class, so the skipped properties come back with their default values.
+		Actors with a Persistent Actor GUID always save every property, loading can find them already in the level with values that are no longer the defaults.
+	*/
+	UPROPERTY(config, Category = "Performance", EditAnywhere, BlueprintReadWrite)
+	bool SaveOnlyPropertiesChangedFromDefaults = false;
+	
 	/**
-		Unchecking this can increase the speed of saving in cases where you have actors with tons of variables that you've added yourself.
+		The checks only look at the object properties being saved, worked out once per class, so they are cheap enough to leave on in shipping builds.
+		Unchecking this still saves a little time in cases where you have actors with tons of object variables that you've added yourself.
 		
 		It is important if you are new to my save system to leave this checked until you understand the type of objects that can and can't be saved. 
 		
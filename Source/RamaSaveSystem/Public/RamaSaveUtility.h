@@ -4,9 +4,152 @@
  
 #include "JoySaveClassFuncLine.h"
 #include "PlatformFilemanager.h"
+#include "RamaSaveArchive.h"
 #include "RamaSaveUtility.generated.h"
 
 #define  PLATFORM_HTML5_BROWSER 0
+
+/** How a save file is compressed. The codec is stored in the file, so loading always picks the right decoder. */
+UENUM(BlueprintType)
+enum class ERamaSaveCodec : uint8
+{
+	/** Use the Compression Codec from the Rama Save System project settings */
+	UseProjectDefault,
+	
+	/** No compression, fastest to save and load but largest files */
+	None,
+	
+	/** Regular zlib, same as save files before codecs were selectable */
+	Zlib,
+	
+	/** Quickest compression, good for frequent autosaves */
+	Fast,
+	
+	/** Smallest files, slowest to save. Loading is as fast as Zlib */
+	HighRatio
+};
+
+/*
+	One actor entry of a save file, pre-parsed on a worker thread.
+	
+	The property data is not copied, it stays in the decoded file and is applied on the game thread.
+*/
+struct FRamaSaveActorRecord
+{
+	FString ActorClass;
+	FString ActorClassFullPath;
+	FGuid PersistentActorUniqueID;
+	TArray<FString> SaveTags;
+	FString LevelPackageName;
+	
+	//Property blob of this actor inside the decoded file
+	int64 PropertiesBegin = 0;
+	int64 RecordEnd = 0;
+	
+	//String table entries of the objects its values reference, from the directory
+	TArray<uint32> ObjectIndices;
+};
+
+/*
+	The small sections of a save file, built on the game thread before the actor payload.
+	See RamaSaveSectionFile.h
+*/
+struct FRamaSaveFileSections
+{
+	TArray<uint8> Header;
+	TArray<uint8> Streaming;
+	TArray<uint8> StaticData;
+	
+	//Written after the actors, once every string they use is known
+	TArray<uint8> Strings;
+	TArray<uint8> Directory;
+	TArray<uint8> Layouts;
+};
+
+/*
+	What a save task reports back, owned by the engine and shared with the task.
+	Written on the worker thread, read on the game thread once the task is complete.
+*/
+struct FRamaSaveWriteResult
+{
+	bool bSucceeded = false;
+	bool bAllRecordsWritten = true;
+	int64 Size = -1;		//Not known when streaming
+};
+typedef TSharedRef<FRamaSaveWriteResult, ESPMode::ThreadSafe> FRamaSaveWriteResultRef;
+
+/*
+	A save file after decompression.
+	
+	Created once at the start of a load and shared by every stage that needs the bytes
+	(streaming level state, Phase2), then released when the load finishes.
+	
+	Decompression and parsing happen on a worker thread, the game thread only reads
+	the parsed members once the matching flag is set.
+*/
+struct FRamaSaveDecodedFile
+{
+	FString FileName;
+	TArray<uint8> Data;
+	
+	//Memory mapped files and Streaming Save Load are read through this instead of Data
+	bool bStreaming = false;
+	TUniquePtr<FArchive> FileReader;
+	
+	//~~~ Filled in by the worker thread ~~~
+	int32 SaveVersion = 0;
+	int32 SavedUE4Version = 0;
+	FEngineVersion SavedEngineVersion;
+	TArray<FString> StreamingLevelNames;
+	TBitArray<> StreamingLevelVisible;
+	
+	//Empty for files older than the string table
+	FRamaSaveStringTable Strings;
+	bool bHasStrings = false;
+	
+	FRamaSaveStringTable* GetStrings() { return bHasStrings ? &Strings : nullptr; }
+	
+	//Empty for files older than the actor directory
+	FRamaSaveActorDirectory Directory;
+	bool bHasDirectory = false;
+	
+	//Empty for files older than property layouts
+	FRamaSaveLayoutTable Layouts;
+	bool bHasLayouts = false;
+	
+	FRamaSaveLayoutTable* GetLayouts() { return bHasLayouts ? &Layouts : nullptr; }
+	
+	//Only the records that pass the load filters (tags, streaming level)
+	TArray<FRamaSaveActorRecord> Records;
+	bool bValid = false;
+	
+	bool bPreloaded = false;				//Game thread, classes and assets were streamed in
+	
+	FThreadSafeBool bHeaderReady = false;	//Streaming level names and visibility can be read
+	FThreadSafeBool bFinished = false;		//Everything can be read
+};
+typedef TSharedPtr<FRamaSaveDecodedFile, ESPMode::ThreadSafe> FRamaSaveDecodedFilePtr;
+
+/*
+	Serialization buffers kept between saves, so a steady state save does no large reallocations.
+	
+	Every buffer handed out is pre-sized from the final size of the last save. 
+	Game thread only, async save tasks hand their buffer back via the engine.
+*/
+struct FRamaSaveBufferPool
+{
+	//Final size of the most recent completed save
+	int64 LastSaveSize = 0;
+	
+	TArray<TArray<uint8>> FreeBuffers;
+	
+	TArray<uint8> Acquire();
+	void Release(TArray<uint8>&& Buffer);
+	
+	//Free everything, for memory pressure
+	void Trim();
+};
+
 /*
 	C++ Static Function Library Class for Rama Save System
 */
@@ -43,9 +186,11 @@ public:
 	}
 public:
  
+	//Anything inside a level (its path has PersistentLevel in it) exists only at runtime, it is not an asset on disk.
+	//	Walks the outers instead of building the path string
 	static FORCEINLINE bool VerifyObjectCanBeLoaded(UObject* Obj)
 	{  
-		return !FStringAssetReference(Obj).ToString().Contains("PersistentLevel");
+		return !Obj->IsA<ULevel>() && !Obj->GetTypedOuter<ULevel>();
 	}
 	
 public:
@@ -73,8 +218,32 @@ public:
 	
 	//! File Compression, by Rama
 	static bool DecompressFromFile(const FString& FullFilePath, TArray<uint8>& Uncompressed);
-	static bool CompressAndWriteToFile(TArray<uint8>& Uncompressed, const FString& FullFilePath);
+	
+	/*
+		Reads a save file in place when possible, instead of decompressing all of it into memory. 
+		Uncompressed files are memory mapped, compressed block files are read WindowBlocks at a time if bAllowStreaming. 
+		
+		nullptr means use DecompressFromFile.
+	*/
+	static FArchive* OpenFileReader(const FString& FullFilePath, bool bAllowStreaming, int32 WindowBlocks = 0);
+	static bool CompressAndWriteToFile(TArray<uint8>& Uncompressed, const FString& FullFilePath, ERamaSaveCodec Codec = ERamaSaveCodec::Zlib);
+	
+	//Every section compressed on its own, Actors is the actor payload
+	static bool WriteSectionedFile(const FString& FullFilePath, const FRamaSaveFileSections& Sections, const TArray<uint8>& Actors, ERamaSaveCodec Codec);
 	//! File Compression, by Rama
 	
+	//UseProjectDefault -> project setting, call on game thread
+	static ERamaSaveCodec ResolveCodec(ERamaSaveCodec Codec);
+	
+	/*
+		Block framed files, independently compressed fixed size blocks plus a block table 
+		so that compression and decompression can use every core. 
+		
+		Files written before this are a single zlib stream and still load via DecompressFromFile.
+	*/
+	static bool IsBlockFramed(const TArray<uint8>& FileData);
+	static bool CompressBlocks(const TArray<uint8>& Uncompressed, TArray<uint8>& FileData, ERamaSaveCodec Codec);
+	static bool DecompressBlocks(const TArray<uint8>& FileData, TArray<uint8>& Uncompressed);
+	
 	
 };
\ No newline at end of file
@@ -15,5 +15,8 @@ public class RamaSaveSystem : ModuleRules
 				"InputCore"
 			}
 		);
+		
+		//Save file compression levels
+		AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
 	}
 }